@@ -0,0 +1,199 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+/*
+  Replays a recorded stream of deposits and payments through a utxo_pool
+  and prints how the unspent output set grows, one row per event.
+
+  Usage: select_outputs EVENTS [ALGORITHM] [FEE_PER_KB] [SMALL_CHANGE]
+
+  EVENTS holds one event per line, "deposit VALUE" or "pay VALUE" in
+  satoshis. Blank lines and lines starting with '#' are skipped.
+  ALGORITHM is greedy (the default), branch_and_bound, knapsack,
+  largest_first or smallest_first. Payments it cannot fund are retried
+  with greedy, as a wallet would. Change outputs below SMALL_CHANGE
+  satoshis (default 5460, ten times the dust threshold) are counted as
+  small, since they cost a large part of their value to spend later.
+
+  Rows are CSV on standard output:
+    step,event,value,funded,inputs,fee,change,utxo_count,utxo_value
+  A summary follows on standard error. Payments funded by the greedy
+  retry are totalled apart from the rest, and the time per selection
+  counts every select() call, retries and failures included.
+*/
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <bitcoin/bitcoin.hpp>
+#include <wallet/transaction.hpp>
+#include <wallet/utxo_pool.hpp>
+
+using namespace libwallet;
+
+bool parse_algorithm(const std::string& name, select_outputs_algorithm& alg)
+{
+    if (name == "greedy")
+        alg = select_outputs_algorithm::greedy;
+    else if (name == "branch_and_bound")
+        alg = select_outputs_algorithm::branch_and_bound;
+    else if (name == "knapsack")
+        alg = select_outputs_algorithm::knapsack;
+    else if (name == "largest_first")
+        alg = select_outputs_algorithm::largest_first;
+    else if (name == "smallest_first")
+        alg = select_outputs_algorithm::smallest_first;
+    else
+        return false;
+    return true;
+}
+
+int main(int argc, char** argv)
+{
+    if (argc < 2 || argc > 5)
+    {
+        std::cerr << "Usage: select_outputs EVENTS [ALGORITHM] [FEE_PER_KB]"
+            " [SMALL_CHANGE]" << std::endl;
+        return 1;
+    }
+    std::ifstream events(argv[1]);
+    if (!events)
+    {
+        std::cerr << "Cannot open " << argv[1] << std::endl;
+        return 1;
+    }
+    auto alg = select_outputs_algorithm::greedy;
+    if (argc > 2 && !parse_algorithm(argv[2], alg))
+    {
+        std::cerr << "Unknown algorithm " << argv[2] << std::endl;
+        return 1;
+    }
+    select_outputs_fee fee;
+    if (argc > 3)
+        fee.fee_per_kb = std::strtoull(argv[3], nullptr, 10);
+    uint64_t small_change = 10 * fee.dust_threshold;
+    if (argc > 4)
+        small_change = std::strtoull(argv[4], nullptr, 10);
+
+    utxo_pool pool;
+    uint32_t next_index = 0;
+    auto add_output = [&](uint64_t value)
+    {
+        output_info_type output;
+        output.point.hash = libbitcoin::null_hash;
+        output.point.index = next_index++;
+        output.value = value;
+        pool.insert(output);
+    };
+
+    // Totals for payments funded by the chosen algorithm, then for those
+    // funded by the greedy retry.
+    struct totals
+    {
+        size_t payments = 0;
+        size_t inputs = 0;
+        uint64_t fees = 0;
+    } direct, fallback;
+    size_t step = 0, failures = 0, selections = 0, max_pool_size = 0;
+    size_t small_changes = 0;
+    uint64_t small_change_value = 0;
+    std::chrono::duration<double> elapsed(0);
+    std::cout << "step,event,value,funded,inputs,fee,change,"
+        "utxo_count,utxo_value" << std::endl;
+
+    std::string line;
+    for (size_t line_number = 1; std::getline(events, line); ++line_number)
+    {
+        if (line.empty() || line[0] == '#')
+            continue;
+        std::istringstream fields(line);
+        std::string kind;
+        uint64_t value = 0;
+        if (!(fields >> kind >> value) || (kind != "deposit" && kind != "pay"))
+        {
+            std::cerr << argv[1] << ":" << line_number
+                << ": expected \"deposit VALUE\" or \"pay VALUE\""
+                << std::endl;
+            return 1;
+        }
+
+        select_outputs_result result;
+        if (kind == "deposit")
+            add_output(value);
+        else
+        {
+            totals* funded_by = &direct;
+            const auto start = std::chrono::steady_clock::now();
+            result = pool.select(value, fee, alg);
+            ++selections;
+            if (result.points.empty() &&
+                alg != select_outputs_algorithm::greedy)
+            {
+                result = pool.select(value, fee);
+                ++selections;
+                funded_by = &fallback;
+            }
+            elapsed += std::chrono::steady_clock::now() - start;
+            if (result.points.empty())
+                ++failures;
+            else
+            {
+                pool.spend(result);
+                ++funded_by->payments;
+                funded_by->inputs += result.points.size();
+                funded_by->fees += result.fee;
+                if (result.change)
+                    add_output(result.change);
+                if (result.change && result.change < small_change)
+                {
+                    ++small_changes;
+                    small_change_value += result.change;
+                }
+            }
+        }
+        max_pool_size = std::max(max_pool_size, pool.size());
+
+        const bool funded = kind == "pay" && !result.points.empty();
+        std::cout << step++ << "," << kind << "," << value << ","
+            << funded << "," << result.points.size() << ","
+            << result.fee << "," << result.change << ","
+            << pool.size() << "," << pool.total_value() << std::endl;
+    }
+
+    auto print_totals = [](const totals& paid, const char* by)
+    {
+        std::cerr << paid.payments << " paid by " << by << ", "
+            << (paid.payments ? double(paid.inputs) / paid.payments : 0)
+            << " inputs/tx, " << paid.fees << " fees" << std::endl;
+    };
+    print_totals(direct, argc > 2 ? argv[2] : "greedy");
+    print_totals(fallback, "greedy retry");
+    std::cerr << failures << " unfunded, "
+        << (selections ? elapsed.count() * 1e6 / selections : 0)
+        << " us/selection over " << selections << " selections" << std::endl;
+    std::cerr << small_changes << " change outputs below " << small_change
+        << ", " << small_change_value << " in total" << std::endl;
+    std::cerr << "utxo set " << max_pool_size << " max / "
+        << pool.size() << " final" << std::endl;
+    return 0;
+}
+
@@ -0,0 +1,97 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBWALLET_ADDRESS_CACHE_HPP
+#define LIBWALLET_ADDRESS_CACHE_HPP
+
+#include <list>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <bitcoin/address.hpp>
+#include <wallet/define.hpp>
+
+namespace libwallet {
+
+using namespace libbitcoin;
+
+/**
+ * Same as address.set_encoded(encoded), decoding the 25 bytes on the
+ * stack with the fixed-size Base58 decoder.
+ */
+BCW_API bool decode_address(payment_address& address,
+    const std::string& encoded);
+
+/**
+ * Remembers recently decoded payment addresses, so parsing the same
+ * encoded address again skips the Base58 decode and checksum.
+ * Holds at most capacity addresses, dropping the least recently used.
+ * Safe to share between threads; the entries are split into shards with
+ * a lock each so threads rarely wait on one another.
+ *
+ * @code
+ *  address_cache cache;
+ *  uri_parse_result result(&cache);
+ *  uri_parse(uri, result);
+ * @endcode
+ */
+class address_cache
+{
+public:
+    BCW_API explicit address_cache(size_t capacity=4096, size_t shards=16);
+
+    /**
+     * Same as address.set_encoded(encoded), using the cache when the
+     * address has been seen before. Only valid addresses are cached.
+     */
+    BCW_API bool set_encoded(payment_address& address,
+        const std::string& encoded);
+
+    /**
+     * True if encoded is cached. Does not count as a use.
+     */
+    BCW_API bool contains(const std::string& encoded) const;
+
+    BCW_API size_t size() const;
+    BCW_API void clear();
+
+private:
+    typedef std::pair<std::string, payment_address> entry;
+    typedef std::list<entry> entry_list;
+
+    struct shard
+    {
+        std::mutex mutex;
+        // Most recently used first.
+        entry_list entries;
+        std::unordered_map<std::string, entry_list::iterator> index;
+    };
+
+    shard& shard_for(const std::string& encoded) const;
+
+    const size_t shard_capacity_;
+    std::vector<std::unique_ptr<shard>> shards_;
+};
+
+} // namespace libwallet
+
+#endif
+
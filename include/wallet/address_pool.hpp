@@ -0,0 +1,148 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBWALLET_ADDRESS_POOL_HPP
+#define LIBWALLET_ADDRESS_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <bitcoin/address.hpp>
+#include <wallet/define.hpp>
+#include <wallet/hd_keys.hpp>
+
+namespace libwallet {
+
+using namespace libbitcoin;
+
+/**
+ * A receive address handed out by an address_pool, with the child index
+ * it was derived at.
+ */
+struct BCW_API issued_address
+{
+    uint32_t index;
+    payment_address address;
+};
+
+/**
+ * Hands out fresh receive addresses from the non-hardened children of an
+ * extended public key, in index order. A background thread derives
+ * addresses ahead of time into a fixed ring and tops it up whenever it
+ * drops below low_watermark, so next_address() is normally a single
+ * lock-free dequeue. Safe to call from any number of threads.
+ *
+ * Addresses derived but not yet issued are not used again after the
+ * pool is destroyed. Persist next_index() and pass it back in to resume.
+ *
+ * @code
+ *  address_pool pool(account, stored_next_index);
+ *  // On each request:
+ *  issued_address issued;
+ *  if (pool.next_address(issued))
+ *      show(issued.address.encoded());
+ *  // On shutdown:
+ *  store(pool.next_index());
+ * @endcode
+ */
+class address_pool
+{
+public:
+    /**
+     * The ring holds capacity addresses, rounded up to a power of two.
+     * A low_watermark of 0 refills once half the ring is used.
+     */
+    BCW_API address_pool(const hd_public_key& key, uint32_t first_index=0,
+        size_t capacity=1024, size_t low_watermark=0);
+
+    /**
+     * Stops the background thread.
+     */
+    BCW_API ~address_pool();
+
+    address_pool(const address_pool&) = delete;
+    address_pool& operator=(const address_pool&) = delete;
+
+    /**
+     * Takes the next address. Waits for the background thread only if
+     * the ring has run dry. Returns false once every non-hardened child
+     * has been issued.
+     */
+    BCW_API bool next_address(issued_address& issued);
+
+    /**
+     * One past the highest index issued so far, or first_index if none.
+     */
+    BCW_API uint32_t next_index() const;
+
+    /**
+     * Addresses derived and waiting to be issued.
+     */
+    BCW_API size_t size() const;
+
+private:
+    // Bounded multi-producer multi-consumer ring (Vyukov). A slot is
+    // free for the write at position p when its sequence is p, and holds
+    // the value for the read at p once its sequence is p + 1.
+    struct slot
+    {
+        std::atomic<size_t> sequence;
+        issued_address value;
+    };
+
+    bool push(const issued_address& value);
+    bool pop(issued_address& value);
+    void request_refill();
+    void refill();
+
+    const hd_public_key key_;
+    const size_t capacity_;
+    const size_t low_watermark_;
+    std::unique_ptr<slot[]> slots_;
+
+    // Ring positions, each on its own cache line as writers and readers
+    // move them independently.
+    struct position
+    {
+        std::atomic<size_t> value;
+        char padding[64];
+    };
+
+    position write_;
+    position read_;
+    std::atomic<uint32_t> next_index_;
+
+    // Refill thread state. derive_index_ belongs to the thread.
+    uint32_t derive_index_;
+    std::atomic<bool> refill_requested_;
+    std::atomic<bool> exhausted_;
+    std::atomic<bool> stopping_;
+    std::mutex mutex_;
+    std::condition_variable refill_wanted_;
+    std::condition_variable refilled_;
+    std::thread refill_thread_;
+};
+
+} // namespace libwallet
+
+#endif
+
@@ -0,0 +1,124 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBWALLET_BASE58_HPP
+#define LIBWALLET_BASE58_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <bitcoin/types.hpp>
+#include <wallet/define.hpp>
+
+namespace libwallet {
+
+using namespace libbitcoin;
+
+// Largest payload the fixed-size Base58 routines handle.
+constexpr size_t base58_max_size = 128;
+
+/**
+ * Room needed to encode size bytes, which is an upper bound on
+ * size * log(256) / log(58).
+ */
+constexpr size_t base58_encoded_size(size_t size)
+{
+    return size * 138 / 100 + 1;
+}
+
+/**
+ * Encodes size bytes of data into out, which must have room for
+ * base58_encoded_size(size) characters. Returns the encoded length, or
+ * 0 if size is over base58_max_size. Does not add a terminator.
+ * Works on 32-bit limbs, five digits per division, in place of the
+ * byte at a time libbitcoin encode_base58().
+ */
+BCW_API size_t encode_base58_fixed(const uint8_t* data, size_t size,
+    char* out);
+
+/**
+ * Decodes size characters into at most capacity bytes of out.
+ * Returns the decoded length, or 0 if the text is empty, contains a
+ * character outside the alphabet or does not fit.
+ */
+BCW_API size_t decode_base58_fixed(const char* text, size_t size,
+    uint8_t* out, size_t capacity);
+
+/**
+ * Base58Check: the payload followed by the first four bytes of its
+ * double SHA-256. Payloads may be up to base58_max_size - 4 bytes.
+ */
+BCW_API std::string encode_base58check_fixed(const uint8_t* payload,
+    size_t size);
+
+/**
+ * Decodes Base58Check text whose payload is exactly size bytes long.
+ * Returns false on a bad character, length or checksum.
+ */
+BCW_API bool decode_base58check_fixed(const char* text, size_t text_size,
+    uint8_t* payload, size_t size);
+
+/**
+ * Encodes a fixed-size payload without allocating anything other than
+ * the result.
+ *
+ * @code
+ *  byte_array<25> raw = ...;
+ *  std::string encoded = encode_base58_fixed(raw);
+ * @endcode
+ */
+template <size_t Size>
+std::string encode_base58_fixed(const byte_array<Size>& data)
+{
+    static_assert(Size <= base58_max_size, "payload too large");
+    char out[base58_encoded_size(Size)];
+    return std::string(out, encode_base58_fixed(data.data(), Size, out));
+}
+
+/**
+ * Decodes text which must hold exactly Size bytes.
+ */
+template <size_t Size>
+bool decode_base58_fixed(const std::string& text, byte_array<Size>& out)
+{
+    static_assert(Size <= base58_max_size, "payload too large");
+    return decode_base58_fixed(text.data(), text.size(),
+        out.data(), Size) == Size;
+}
+
+template <size_t Size>
+std::string encode_base58check_fixed(const byte_array<Size>& payload)
+{
+    static_assert(Size + 4 <= base58_max_size, "payload too large");
+    return encode_base58check_fixed(payload.data(), Size);
+}
+
+template <size_t Size>
+bool decode_base58check_fixed(const std::string& text,
+    byte_array<Size>& payload)
+{
+    static_assert(Size + 4 <= base58_max_size, "payload too large");
+    return decode_base58check_fixed(text.data(), text.size(),
+        payload.data(), Size);
+}
+
+} // namespace libwallet
+
+#endif
+
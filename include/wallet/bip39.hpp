@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option) 
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBWALLET_BIP39_HPP
+#define LIBWALLET_BIP39_HPP
+
+#include <string>
+#include <bitcoin/types.hpp>
+#include <wallet/define.hpp>
+#include <wallet/mnemonic.hpp>
+
+namespace libwallet {
+
+using namespace libbitcoin;
+
+constexpr size_t bip39_word_count = 2048;
+constexpr size_t bip39_seed_size = 64;
+
+/**
+ * Encodes entropy as a BIP 39 mnemonic using the English word list.
+ * The entropy must be 16 to 32 bytes long in steps of 4 bytes.
+ * Returns an empty list on error.
+ *
+ * @code
+ *  string_list words = encode_bip39_mnemonic(entropy);
+ *  if (words.empty())
+ *      // Error...
+ * @endcode
+ */
+BCW_API string_list encode_bip39_mnemonic(const data_chunk& entropy);
+
+/**
+ * Recovers the entropy from a BIP 39 mnemonic.
+ * Returns an empty chunk if a word is unknown or the checksum is wrong.
+ */
+BCW_API data_chunk decode_bip39_mnemonic(const string_list& words);
+
+/**
+ * Checks that every word is in the list and the checksum matches.
+ */
+BCW_API bool validate_bip39_mnemonic(const string_list& words);
+
+/**
+ * Derives the 64 byte BIP 39 seed from a mnemonic with PBKDF2-HMAC-SHA512.
+ * The words and passphrase are used as given, so they must already be
+ * NFKD normalized (a no-op for the English list and ASCII passphrases).
+ * The checksum is not checked, use validate_bip39_mnemonic() for that.
+ *
+ * @code
+ *  hd_private_key master(bip39_to_seed(words, passphrase));
+ * @endcode
+ */
+BCW_API data_chunk bip39_to_seed(const string_list& words,
+    const std::string& passphrase="");
+
+} // namespace libwallet
+
+#endif
+
@@ -19,6 +19,8 @@
 #ifndef LIBWALLET_HD_KEYS_HPP
 #define LIBWALLET_HD_KEYS_HPP
 
+#include <string>
+#include <vector>
 #include <bitcoin/address.hpp>
 #include <bitcoin/utility/ec_keys.hpp>
 #include <wallet/define.hpp>
@@ -32,6 +34,10 @@ typedef byte_array<chain_code_size> chain_code_type;
 
 constexpr uint32_t first_hardened_key = 1 << 31;
 
+// Seed lengths BIP 32 allows, in bytes.
+constexpr size_t hd_min_seed_size = 16;
+constexpr size_t hd_max_seed_size = 64;
+
 /**
  * Key derivation information used in the serialization format.
  */
@@ -97,6 +103,45 @@ protected:
     ec_secret k_;
 };
 
+/**
+ * A BIP 32 master key in both serializations, with the seed it came
+ * from. The seed is the backup, so keep it with the keys.
+ */
+struct BCW_API hd_master_key
+{
+    bool valid;
+    data_chunk seed;
+    std::string private_key;
+    std::string public_key;
+};
+
+typedef std::vector<hd_master_key> hd_master_key_list;
+
+/**
+ * Derives the master key for each seed, as hd_private_key(seed) would,
+ * and serializes it as xprv and xpub. Work is spread across threads,
+ * where 0 uses every core. A seed whose master secret is out of range
+ * gives an entry that is not valid.
+ */
+BCW_API hd_master_key_list generate_hd_masters(
+    const std::vector<data_chunk>& seeds, bool testnet=false,
+    size_t threads=0);
+
+/**
+ * Generates count master keys from fresh random seeds of seed_size bytes.
+ * Every entry is valid. Returns an empty list if seed_size is outside
+ * [hd_min_seed_size, hd_max_seed_size] or the seeds would not fit in
+ * memory.
+ *
+ * @code
+ *  for (const hd_master_key& master: generate_hd_masters(1000))
+ *      store(encode_hex(master.seed), master.private_key,
+ *          master.public_key);
+ * @endcode
+ */
+BCW_API hd_master_key_list generate_hd_masters(size_t count,
+    size_t seed_size=32, bool testnet=false, size_t threads=0);
+
 } // namespace libwallet
 
 #endif
@@ -20,6 +20,7 @@
 #define LIBWALLET_KEY_FORMATS_HPP
 
 #include <string>
+#include <vector>
 #include <bitcoin/utility/ec_keys.hpp>
 #include <wallet/define.hpp>
 
@@ -54,10 +55,35 @@ BCW_API std::string secret_to_wif(
  */
 BCW_API ec_secret wif_to_secret(const std::string& wif);
 
+/**
+ * Everything in a wallet import format key. Fields other than valid
+ * are zeroed if the key did not decode.
+ */
+struct BCW_API wif_key
+{
+    bool valid = false;
+    uint8_t version = 0;
+    ec_secret secret{{}};
+    bool compressed = false;
+};
+
+/**
+ * Decodes and checks a wallet import format key in one pass, without
+ * allocating. Returns false on a bad length, checksum, version or
+ * compression flag.
+ *
+ * @code
+ *  wif_key key;
+ *  if (!decode_wif(wif.data(), wif.size(), key))
+ *      // Error...
+ * @endcode
+ */
+BCW_API bool decode_wif(const char* wif, size_t size, wif_key& key);
+BCW_API wif_key decode_wif(const std::string& wif);
+
 /**
  * Checks to see if a wif refers to a compressed public key.
- * This does no other checks on the validity of the wif.
- * Returns false otherwise.
+ * Returns false if it does not or the wif is invalid.
  *
  * @code
  *  bool compressed = is_wif_compressed(
@@ -81,6 +107,72 @@ BCW_API bool is_wif_compressed(const std::string& wif);
  */
 BCW_API ec_secret minikey_to_secret(const std::string& minikey);
 
+/**
+ * Checks that a Casascius minikey has a valid length and that its hash
+ * with "?" appended starts with a zero byte. Does not allocate.
+ */
+BCW_API bool check_minikey(const char* minikey, size_t size);
+BCW_API bool check_minikey(const std::string& minikey);
+
+/**
+ * Checks many minikeys across threads, where 0 uses every core.
+ * Returns the positions of the invalid ones.
+ */
+BCW_API std::vector<size_t> validate_minikeys(
+    const std::vector<std::string>& minikeys, size_t threads=0);
+
+/**
+ * Generates count random 30 character minikeys across threads, where 0
+ * uses every core.
+ *
+ * @code
+ *  string_list minikeys = generate_minikeys(100000);
+ *  for (const std::string& minikey: minikeys)
+ *      print_coin(minikey, minikey_to_secret(minikey));
+ * @endcode
+ */
+BCW_API std::vector<std::string> generate_minikeys(size_t count,
+    size_t threads=0);
+
+/**
+ * A key read by import_keys(), with what is needed to look up its coins.
+ * Fields other than valid are zeroed if the key did not decode.
+ */
+struct BCW_API imported_key
+{
+    bool valid = false;
+    ec_secret secret{{}};
+    bool compressed = false;
+    ec_point public_key;
+    // Hash of public_key, as in a pay-to-pubkey-hash address.
+    short_hash hash{{}};
+};
+
+/**
+ * Result of import_keys(). keys lines up with the input, and invalid
+ * lists the positions of the entries that did not decode.
+ */
+struct BCW_API key_import_result
+{
+    std::vector<imported_key> keys;
+    std::vector<size_t> invalid;
+};
+
+/**
+ * Decodes a batch of WIF keys and Casascius minikeys, as for sweeping
+ * paper wallets, and derives their public keys and hashes. The work is
+ * spread over threads, where 0 uses every core. Minikeys are always
+ * uncompressed.
+ *
+ * @code
+ *  key_import_result result = import_keys(lines);
+ *  for (size_t index: result.invalid)
+ *      log_warning() << "Bad key on line " << index + 1;
+ * @endcode
+ */
+BCW_API key_import_result import_keys(const std::vector<std::string>& keys,
+    size_t threads=0);
+
 } // libwallet
 
 #endif
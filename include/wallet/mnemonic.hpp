@@ -20,6 +20,7 @@
 #ifndef LIBBITCOIN_MNEMONIC_HPP
 #define LIBBITCOIN_MNEMONIC_HPP
 
+#include <cstdint>
 #include <string>
 #include <vector>
 #include <bitcoin/define.hpp>
@@ -29,9 +30,57 @@ namespace libwallet {
 
 typedef std::vector<std::string> string_list;
 
+/**
+ * Position of a word in the Electrum mnemonic word list.
+ */
+typedef uint16_t mnemonic_index;
+constexpr size_t mnemonic_word_count = 1626;
+
 BCW_API string_list encode_mnemonic(const std::string& seed);
 BCW_API const std::string decode_mnemonic(const string_list& words);
 
+/**
+ * Returns the word at index in the mnemonic word list,
+ * or nullptr if index is out of range.
+ */
+BCW_API const char* mnemonic_word(mnemonic_index index);
+
+/**
+ * Returns the position of a word in the mnemonic word list,
+ * or mnemonic_word_count if the word is not in the list.
+ */
+BCW_API size_t mnemonic_word_index(const char* word, size_t size);
+
+/**
+ * Allocation-free form of encode_mnemonic(). Every 8 hex characters of
+ * the seed produce 3 word indexes, so indexes must have room for
+ * 3 * (seed_size / 8) entries. Trailing characters are ignored.
+ * Returns false if the seed contains a non-hex character.
+ *
+ * @code
+ *  mnemonic_index indexes[12];
+ *  if (!encode_mnemonic(seed.data(), seed.size(), indexes))
+ *      // Error...
+ * @endcode
+ */
+BCW_API bool encode_mnemonic(const char* seed, size_t seed_size,
+    mnemonic_index* indexes);
+
+/**
+ * Allocation-free form of decode_mnemonic(). Every 3 word indexes produce
+ * 8 zero-padded lowercase hex characters, so seed must have room for
+ * 8 * (count / 3) characters. No null terminator is written.
+ * Returns false if an index is out of range.
+ *
+ * @code
+ *  char seed[32];
+ *  if (!decode_mnemonic(indexes, 12, seed))
+ *      // Error...
+ * @endcode
+ */
+BCW_API bool decode_mnemonic(const mnemonic_index* indexes, size_t count,
+    char* seed);
+
 } // libwallet
 
 #endif
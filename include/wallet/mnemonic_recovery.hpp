@@ -0,0 +1,135 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBWALLET_MNEMONIC_RECOVERY_HPP
+#define LIBWALLET_MNEMONIC_RECOVERY_HPP
+
+#include <atomic>
+#include <functional>
+#include <vector>
+#include <bitcoin/address.hpp>
+#include <wallet/define.hpp>
+#include <wallet/mnemonic.hpp>
+
+namespace libwallet {
+
+using namespace libbitcoin;
+
+/**
+ * What a recovered mnemonic must reproduce.
+ * If master_public_key is set it is compared against
+ * deterministic_wallet::master_public_key(), otherwise the wallet must
+ * generate address among its first key_count keys.
+ */
+struct BCW_API mnemonic_recovery_target
+{
+    data_chunk master_public_key;
+    payment_address address;
+    size_t key_count;
+    bool for_change;
+};
+
+/**
+ * Snapshot of a running recovery, passed to the progress handler.
+ */
+struct BCW_API mnemonic_recovery_progress
+{
+    uint64_t tried;
+    uint64_t total;
+    double seconds;
+    double rate;
+};
+
+typedef std::function<void (const mnemonic_recovery_progress&)>
+    mnemonic_recovery_handler;
+
+/**
+ * Recovers an Electrum mnemonic with missing or misspelled words by
+ * trying every candidate phrase against a known master public key or
+ * address, spread across several threads.
+ *
+ * @code
+ *  string_list words{"wrote", "", "weaknes", "even", ...};
+ *  mnemonic_recovery recovery(words);
+ *  mnemonic_recovery_target target{mpk, payment_address(), 0, false};
+ *  string_list found;
+ *  if (recovery.recover(target, found, [](
+ *      const mnemonic_recovery_progress& progress)
+ *      {
+ *          log_info() << progress.tried << " / " << progress.total;
+ *      }))
+ *      log_info() << "seed: " << decode_mnemonic(found);
+ * @endcode
+ */
+class mnemonic_recovery
+{
+public:
+    typedef std::vector<mnemonic_index> index_list;
+
+    /**
+     * Words that are empty or "?" are missing and may be any word.
+     * Words that are not in the word list are misspelled and may be any
+     * word within max_distance edits, or any word if none is that close
+     * or max_distance is 0.
+     */
+    BCW_API mnemonic_recovery(const string_list& words,
+        size_t max_distance=2);
+
+    /**
+     * Number of phrases recover() will try, or 0 if the phrase does not
+     * have the 12 words of an Electrum seed.
+     */
+    BCW_API uint64_t candidate_count() const;
+
+    /**
+     * Candidate word indexes for each position, closest first.
+     */
+    BCW_API const std::vector<index_list>& candidates() const;
+
+    /**
+     * Tries candidates until one matches target, returning false if none
+     * does or stop() was called. Blocks the calling thread, which invokes
+     * handle_progress every interval_seconds.
+     * A thread count of 0 uses every available core.
+     */
+    BCW_API bool recover(const mnemonic_recovery_target& target,
+        string_list& result,
+        mnemonic_recovery_handler handle_progress=nullptr,
+        size_t threads=0, double interval_seconds=1.0);
+
+    /**
+     * Makes a running recover() return early, and any later one return
+     * false at once. Safe to call from the progress handler or from
+     * another thread, including before recover() starts.
+     */
+    BCW_API void stop();
+
+private:
+    void decode_candidate(uint64_t number, index_list& indexes) const;
+    bool check_candidate(const mnemonic_recovery_target& target,
+        const index_list& indexes) const;
+
+    std::vector<index_list> candidates_;
+    std::atomic<bool> stopped_;
+};
+
+} // namespace libwallet
+
+#endif
+
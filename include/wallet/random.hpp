@@ -0,0 +1,76 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBWALLET_RANDOM_HPP
+#define LIBWALLET_RANDOM_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/types.hpp>
+#include <bitcoin/utility/ec_keys.hpp>
+#include <wallet/define.hpp>
+
+namespace libwallet {
+
+using namespace libbitcoin;
+
+/**
+ * Fills data with bytes straight from the operating system
+ * (getrandom or /dev/urandom, RtlGenRandom on Windows).
+ * Returns false if the system source failed.
+ */
+BCW_API bool system_random_fill(uint8_t* data, size_t size);
+
+/**
+ * Fills data with cryptographically secure random bytes for keys and
+ * seeds. Each thread runs its own ChaCha20 generator keyed from
+ * system_random_fill(), so bulk use does not make a system call per
+ * request. The generator replaces its key after every refill, reseeds
+ * from the system periodically and after fork(). Aborts the process if
+ * the system source fails, rather than return predictable bytes.
+ *
+ * @code
+ *  data_chunk entropy(16);
+ *  random_fill(entropy.data(), entropy.size());
+ * @endcode
+ */
+BCW_API void random_fill(uint8_t* data, size_t size);
+
+/**
+ * A uniformly random valid secp256k1 secret key.
+ */
+BCW_API ec_secret new_secret();
+
+constexpr size_t chacha20_key_size = 32;
+constexpr size_t chacha20_block_size = 64;
+
+/**
+ * Writes the ChaCha20 (RFC 7539) block for key and a 64 bit block
+ * counter to out, with a zero nonce. The counter's high half takes the
+ * first nonce word, as in the original ChaCha. random_fill() serves
+ * this keystream, and it is public so it can be checked against
+ * published test vectors.
+ */
+BCW_API void chacha20_block(const uint8_t* key, uint64_t counter,
+    uint8_t* out);
+
+} // namespace libwallet
+
+#endif
+
@@ -30,23 +30,93 @@ using namespace libbitcoin;
 struct BCW_API select_outputs_result
 {
     output_point_list points;
-    uint64_t change;
+    uint64_t change = 0;
+    // Only set by the fee-aware select_outputs().
+    uint64_t fee = 0;
+};
+
+// Fee rate and transaction size model for the fee-aware select_outputs().
+// The default sizes are those of pay-to-pubkey-hash transactions.
+struct BCW_API select_outputs_fee
+{
+    explicit select_outputs_fee(uint64_t fee_per_kb=10000)
+      : fee_per_kb(fee_per_kb) {}
+
+    // Fee in satoshis per 1000 bytes.
+    uint64_t fee_per_kb;
+    // Version, locktime and input and output counts.
+    size_t base_size = 10;
+    size_t input_size = 148;
+    size_t output_size = 34;
+    // Number of payment outputs, not counting change.
+    size_t output_count = 1;
+    // Change below this is added to the fee instead.
+    uint64_t dust_threshold = 546;
 };
 
 // Algorithm for call to select_outputs()
 enum class select_outputs_algorithm
 {
-    greedy
+    // Smallest single output that covers the value, otherwise
+    // the largest outputs until the value is reached.
+    greedy,
+    // Depth-first search for a set of outputs matching the value exactly,
+    // so no change output is needed. Fails if there is no such set or
+    // none is found within the iteration budget.
+    branch_and_bound,
+    // Randomized subset search for the smallest total covering the value,
+    // falling back to the smallest single output that covers it.
+    knapsack,
+    // Largest outputs first, which uses the fewest inputs.
+    largest_first,
+    // Smallest outputs first, which consolidates small outputs.
+    smallest_first
 };
 
+// Default work limit for the searching algorithms.
+constexpr size_t select_outputs_default_iterations = 100000;
+
 /**
  * Select optimal outputs for a send from unspent outputs list.
  * Returns output list and remaining change to be sent to
- * a change address.
+ * a change address. An empty output list means no selection was found.
+ * max_iterations bounds the work done by branch_and_bound and knapsack.
+ * The unspent outputs are neither copied nor reordered.
+ */
+BCW_API select_outputs_result select_outputs(
+    const output_info_list& unspent, uint64_t min_value,
+    select_outputs_algorithm alg=select_outputs_algorithm::greedy,
+    size_t max_iterations=select_outputs_default_iterations);
+
+/**
+ * Fee-aware select_outputs(). Each output counts at its effective value,
+ * its value less the fee for the input spending it, and outputs worth
+ * no more than that fee are never chosen. The selection covers min_value
+ * plus the fee for the whole transaction, which is returned in fee.
+ * Change too small to be worth its own output is added to the fee and
+ * change is returned as 0. branch_and_bound accepts any such changeless
+ * selection.
  */
 BCW_API select_outputs_result select_outputs(
-    output_info_list unspent, uint64_t min_value,
-    select_outputs_algorithm alg=select_outputs_algorithm::greedy);
+    const output_info_list& unspent, uint64_t min_value,
+    const select_outputs_fee& fee,
+    select_outputs_algorithm alg=select_outputs_algorithm::greedy,
+    size_t max_iterations=select_outputs_default_iterations);
+
+/**
+ * select_outputs() over the unspent outputs in [begin, end), for callers
+ * keeping them in some other contiguous container.
+ */
+BCW_API select_outputs_result select_outputs(
+    const output_info_type* begin, const output_info_type* end,
+    uint64_t min_value,
+    select_outputs_algorithm alg=select_outputs_algorithm::greedy,
+    size_t max_iterations=select_outputs_default_iterations);
+BCW_API select_outputs_result select_outputs(
+    const output_info_type* begin, const output_info_type* end,
+    uint64_t min_value, const select_outputs_fee& fee,
+    select_outputs_algorithm alg=select_outputs_algorithm::greedy,
+    size_t max_iterations=select_outputs_default_iterations);
 
 } // namespace libwallet
 
@@ -21,10 +21,14 @@
 #ifndef LIBWALLET_URI_HPP
 #define LIBWALLET_URI_HPP
 
-#include <sstream>
+#include <limits>
+#include <string>
+#include <vector>
 #include <boost/optional.hpp>
+#include <boost/utility/string_ref.hpp>
 #include <wallet/define.hpp>
 #include <bitcoin/address.hpp>
+#include <wallet/address_cache.hpp>
 #include <wallet/define.hpp>
 
 namespace libwallet {
@@ -36,6 +40,18 @@ public:
     virtual bool got_param(std::string& key, std::string& value) = 0;
 };
 
+/**
+ * Receives URI components as views, which point into the parsed string
+ * unless the component was percent-encoded. Views are only valid during
+ * the call.
+ */
+class BCW_API uri_view_visitor
+{
+public:
+    virtual bool got_address(boost::string_ref address) = 0;
+    virtual bool got_param(boost::string_ref key, boost::string_ref value) = 0;
+};
+
 /**
  * A decoded bitcoin URI corresponding to BIP 21 and BIP 72.
  * All string members are UTF-8.
@@ -48,6 +64,12 @@ public:
     typedef boost::optional<uint64_t> optional_amount;
     typedef boost::optional<std::string> optional_string;
 
+    /**
+     * Addresses are looked up in cache, if given, which must outlive
+     * this object.
+     */
+    BCW_API explicit uri_parse_result(address_cache* cache=nullptr);
+
     optional_address address;
     optional_amount amount;
     optional_string label;
@@ -56,11 +78,44 @@ public:
 
     bool got_address(std::string& address);
     bool got_param(std::string& key, std::string& value);
+
+private:
+    address_cache* cache_;
 };
 
 BCW_API bool uri_parse(const std::string& uri,
     uri_visitor& result, bool strict=true);
 
+/**
+ * The fields of uri_parse_result for many URIs, one column per field.
+ * Row i of each column belongs to URI i, and rows that failed to parse
+ * are not valid and have every field unset.
+ */
+struct BCW_API uri_batch_result
+{
+    std::vector<bool> valid;
+    std::vector<uri_parse_result::optional_address> address;
+    std::vector<uri_parse_result::optional_amount> amount;
+    std::vector<uri_parse_result::optional_string> label;
+    std::vector<uri_parse_result::optional_string> message;
+    std::vector<uri_parse_result::optional_string> r;
+};
+
+/**
+ * Parses many URIs, as uri_parse() into a uri_parse_result does,
+ * for bulk processing of stored payment requests.
+ */
+BCW_API uri_batch_result uri_parse_batch(
+    const std::vector<std::string>& uris, bool strict=true,
+    address_cache* cache=nullptr);
+
+/**
+ * Same as uri_parse(), but without copying components that need no
+ * unescaping. Does not allocate unless a component is percent-encoded.
+ */
+BCW_API bool uri_parse(boost::string_ref uri,
+    uri_view_visitor& result, bool strict=true);
+
 #ifdef _WIN32
 constexpr uint64_t invalid_amount = UINT_LEAST64_MAX;
 #else
@@ -71,11 +126,18 @@ constexpr uint64_t invalid_amount = std::numeric_limits<uint64_t>::max();
  * Validates and parses an amount string according to the BIP 21 grammar.
  * @param decmial_place the location of the decimal point. The default
  * value converts bitcoins to satoshis.
- * @return parsed value, or invalid_amount for failure.
+ * @return parsed value, or invalid_amount for failure, including values
+ * too large for 64 bits.
  */
 BCW_API uint64_t parse_amount(const std::string& amount,
     unsigned decimal_place=8);
 
+/**
+ * parse_amount() applied to each string in turn.
+ */
+BCW_API std::vector<uint64_t> parse_amounts(
+    const std::vector<std::string>& amounts, unsigned decimal_place=8);
+
 /**
  * Assembles a bitcoin URI string.
  */
@@ -98,7 +160,9 @@ public:
     BCW_API std::string string() const;
 
 private:
-    std::ostringstream stream_;
+    void start_param(const std::string& key);
+
+    std::string buffer_;
     bool first_param_;
 };
 
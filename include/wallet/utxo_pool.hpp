@@ -0,0 +1,153 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBWALLET_UTXO_POOL_HPP
+#define LIBWALLET_UTXO_POOL_HPP
+
+#include <map>
+#include <bitcoin/transaction.hpp>
+#include <wallet/define.hpp>
+#include <wallet/transaction.hpp>
+
+namespace libwallet {
+
+using namespace libbitcoin;
+
+/**
+ * Inputs for one transaction of a batch, paying the amounts at the
+ * given positions of the batch.
+ */
+struct BCW_API batch_transaction
+{
+    std::vector<size_t> payments;
+    select_outputs_result selection;
+};
+
+typedef std::vector<batch_transaction> batch_transaction_list;
+
+/**
+ * A set of unspent outputs kept ordered by value, for wallets that select
+ * coins repeatedly from a large set which changes a little at a time.
+ * Outputs are added and removed in O(log n). Selecting with greedy,
+ * largest_first or smallest_first costs O(log n) plus the number of
+ * outputs returned. The searching algorithms still visit every output.
+ *
+ * @code
+ *  utxo_pool pool(unspent);
+ *  select_outputs_result result = pool.select(amount);
+ *  if (result.points.empty())
+ *      // Insufficient funds...
+ *  pool.spend(result);
+ * @endcode
+ */
+class utxo_pool
+{
+public:
+    BCW_API utxo_pool();
+    BCW_API explicit utxo_pool(const output_info_list& unspent);
+    BCW_API utxo_pool(const utxo_pool& other);
+    BCW_API utxo_pool& operator=(const utxo_pool& other);
+
+    /**
+     * Adds an output. Returns false if its point is already present.
+     */
+    BCW_API bool insert(const output_info_type& output);
+
+    /**
+     * Removes an output. Returns false if its point is not present.
+     */
+    BCW_API bool remove(const output_point& point);
+
+    /**
+     * Removes every output in a selection.
+     */
+    BCW_API void spend(const select_outputs_result& selection);
+
+    /**
+     * Removes every output in a selection, returning those that were
+     * present with their values.
+     */
+    BCW_API output_info_list take(const output_point_list& points);
+
+    BCW_API bool contains(const output_point& point) const;
+    BCW_API size_t size() const;
+    BCW_API bool empty() const;
+    BCW_API uint64_t total_value() const;
+
+    /**
+     * All outputs, smallest value first.
+     */
+    BCW_API output_info_list outputs() const;
+
+    /**
+     * Same as select_outputs() over outputs(), without removing anything.
+     */
+    BCW_API select_outputs_result select(uint64_t min_value,
+        select_outputs_algorithm alg=select_outputs_algorithm::greedy,
+        size_t max_iterations=select_outputs_default_iterations) const;
+
+    /**
+     * Same as the fee-aware select_outputs() over outputs(), without
+     * removing anything.
+     */
+    BCW_API select_outputs_result select(uint64_t min_value,
+        const select_outputs_fee& fee,
+        select_outputs_algorithm alg=select_outputs_algorithm::greedy,
+        size_t max_iterations=select_outputs_default_iterations) const;
+
+    /**
+     * Selects inputs for a batch of payments, one output per amount.
+     * Payments are kept in order and grouped into as few transactions
+     * as fit in max_size bytes each, or a single transaction if max_size
+     * is 0. fee.output_count is ignored. Returns an empty list if any
+     * transaction cannot be funded or a single payment cannot fit.
+     * The pool is unchanged on return; spend() each selection once its
+     * transaction is sent.
+     */
+    BCW_API batch_transaction_list select_batch(
+        const std::vector<uint64_t>& amounts, const select_outputs_fee& fee,
+        size_t max_size=0,
+        select_outputs_algorithm alg=select_outputs_algorithm::greedy,
+        size_t max_iterations=select_outputs_default_iterations);
+
+private:
+    struct point_less
+    {
+        bool operator()(const output_point& a, const output_point& b) const;
+    };
+    typedef std::multimap<uint64_t, output_point> value_map;
+    typedef std::map<output_point, value_map::iterator, point_less>
+        point_map;
+
+    // Selects by value less input_cost, skipping outputs not worth more
+    // than that, and sets effective_total to the sum of those values.
+    bool select_effective(uint64_t target, uint64_t input_cost,
+        uint64_t tolerance, select_outputs_algorithm alg,
+        size_t max_iterations, select_outputs_result& result,
+        uint64_t& effective_total) const;
+
+    value_map by_value_;
+    point_map by_point_;
+    uint64_t total_value_;
+};
+
+} // namespace libwallet
+
+#endif
+
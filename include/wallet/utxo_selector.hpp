@@ -0,0 +1,137 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBWALLET_UTXO_SELECTOR_HPP
+#define LIBWALLET_UTXO_SELECTOR_HPP
+
+#include <functional>
+#include <map>
+#include <mutex>
+#include <bitcoin/transaction.hpp>
+#include <wallet/define.hpp>
+#include <wallet/transaction.hpp>
+#include <wallet/utxo_pool.hpp>
+
+namespace libwallet {
+
+using namespace libbitcoin;
+
+/**
+ * Outputs held back for one transaction until it is committed or
+ * released. An id of 0 means nothing could be reserved.
+ */
+struct BCW_API utxo_reservation
+{
+    uint64_t id = 0;
+    select_outputs_result selection;
+};
+
+/**
+ * A utxo_pool shared by several threads building transactions at once.
+ * Selected outputs are reserved, so no other thread can select them,
+ * until the transaction is either broadcast (commit) or abandoned
+ * (release).
+ *
+ * The greedy, largest_first and smallest_first selections run under the
+ * lock, as they cost O(log n) plus the outputs selected. The searching
+ * algorithms copy the available outputs to a flat list under the lock,
+ * index and search the copy without it, and take the lock again only to
+ * check and claim the result. If another thread claimed one of those outputs meanwhile the
+ * search is repeated, and after a few such conflicts it runs under the
+ * lock so that it is bound to finish.
+ *
+ * @code
+ *  utxo_selector selector(unspent);
+ *  // On each worker thread:
+ *  utxo_reservation reservation = selector.reserve(amount, fee);
+ *  if (!reservation.id)
+ *      // Insufficient funds...
+ *  if (build_and_send(reservation.selection))
+ *      selector.commit(reservation.id);
+ *  else
+ *      selector.release(reservation.id);
+ * @endcode
+ */
+class utxo_selector
+{
+public:
+    BCW_API utxo_selector();
+    BCW_API explicit utxo_selector(const output_info_list& unspent);
+
+    /**
+     * Makes an output available. Returns false if its point is already
+     * available or reserved.
+     */
+    BCW_API bool insert(const output_info_type& output);
+
+    /**
+     * Removes an available output, for instance one spent elsewhere.
+     * Returns false if its point is not available.
+     */
+    BCW_API bool remove(const output_point& point);
+
+    /**
+     * Selects from the available outputs as utxo_pool::select() does and
+     * reserves the selection.
+     */
+    BCW_API utxo_reservation reserve(uint64_t min_value,
+        select_outputs_algorithm alg=select_outputs_algorithm::greedy,
+        size_t max_iterations=select_outputs_default_iterations);
+    BCW_API utxo_reservation reserve(uint64_t min_value,
+        const select_outputs_fee& fee,
+        select_outputs_algorithm alg=select_outputs_algorithm::greedy,
+        size_t max_iterations=select_outputs_default_iterations);
+
+    /**
+     * Drops a reservation's outputs for good once they are spent.
+     * Returns false if the id is not reserved.
+     */
+    BCW_API bool commit(uint64_t id);
+
+    /**
+     * Makes a reservation's outputs available again.
+     * Returns false if the id is not reserved.
+     */
+    BCW_API bool release(uint64_t id);
+
+    BCW_API size_t available_size() const;
+    BCW_API uint64_t available_value() const;
+    BCW_API size_t reserved_size() const;
+    BCW_API uint64_t reserved_value() const;
+
+private:
+    typedef std::function<select_outputs_result (const utxo_pool&)>
+        selection_function;
+
+    bool available(const output_point_list& points) const;
+    utxo_reservation reserve_selected(select_outputs_algorithm alg,
+        const selection_function& select);
+    utxo_reservation hold(const select_outputs_result& selection);
+
+    mutable std::mutex mutex_;
+    utxo_pool available_;
+    utxo_pool reserved_;
+    std::map<uint64_t, output_point_list> reservations_;
+    uint64_t last_id_;
+};
+
+} // namespace libwallet
+
+#endif
+
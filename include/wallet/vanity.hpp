@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBWALLET_VANITY_HPP
+#define LIBWALLET_VANITY_HPP
+
+#include <array>
+#include <cstdint>
+#include <string>
+#include <vector>
+#include <bitcoin/address.hpp>
+#include <bitcoin/utility/ec_keys.hpp>
+#include <wallet/define.hpp>
+#include <wallet/hd_keys.hpp>
+
+namespace libwallet {
+
+using namespace libbitcoin;
+
+// Version byte, hash and checksum of a payment address.
+constexpr size_t address_payload_size = 1 + short_hash_size + 4;
+
+/**
+ * Tests whether the Base58Check encoding of an address starts with a
+ * given prefix, without encoding it. The prefix is turned into the
+ * ranges of payload values whose encodings start with it, so a test is
+ * a checksum and a few comparisons.
+ *
+ * @code
+ *  base58_prefix prefix("1Kid");
+ *  if (prefix.matches(address.version(), address.hash()))
+ *      ...
+ * @endcode
+ */
+class base58_prefix
+{
+public:
+    BCW_API base58_prefix(const std::string& prefix);
+
+    /**
+     * False if the prefix has characters outside the Base58 alphabet or
+     * is too long for any address to start with it.
+     */
+    BCW_API bool valid() const;
+
+    BCW_API const std::string& text() const;
+
+    /**
+     * Tests a full payload of address_payload_size bytes, checksum
+     * included.
+     */
+    BCW_API bool matches(const uint8_t* payload) const;
+
+    BCW_API bool matches(uint8_t version, const short_hash& hash) const;
+
+    /**
+     * False if no address with this version byte can start with the
+     * prefix, like "3..." for pubkey_version.
+     */
+    BCW_API bool reachable(uint8_t version) const;
+
+private:
+    // Big-endian 32 bit limbs, wide enough for any payload.
+    typedef std::array<uint32_t, 8> number;
+
+    struct range
+    {
+        number low;
+        number high;
+    };
+
+    std::string text_;
+    bool valid_;
+    size_t zeros_;
+    std::vector<range> ranges_;
+};
+
+/**
+ * Searches the non-hardened children of key, starting at first_index and
+ * trying up to count indexes, for addresses that start with prefix.
+ * Only public derivation is used, so key may come from an xpub.
+ * Returns the lowest max_results matching indexes in order, fewer if the
+ * range runs out, and none if prefix is not reachable() for
+ * payment_address::pubkey_version. A thread count of 0 uses every core.
+ *
+ * @code
+ *  base58_prefix prefix("1Shop");
+ *  for (uint32_t index: find_vanity_children(account, prefix))
+ *      log_info() << account.generate_public_key(index).address().encoded();
+ * @endcode
+ */
+BCW_API std::vector<uint32_t> find_vanity_children(
+    const hd_public_key& key, const base58_prefix& prefix,
+    uint32_t first_index=0, uint32_t count=first_hardened_key,
+    size_t max_results=1, size_t threads=0);
+
+/**
+ * Searches random ephemeral secrets for one whose stealth payment to
+ * scan_pubkey and spend_pubkey lands on an address that starts with
+ * prefix. Tries up to max_attempts secrets, or until found if 0.
+ * Returns false if none matched, or at once if prefix is not reachable()
+ * for payment_address::pubkey_version.
+ */
+BCW_API bool find_vanity_stealth(const ec_point& scan_pubkey,
+    const ec_point& spend_pubkey, const base58_prefix& prefix,
+    ec_secret& ephem_secret, uint64_t max_attempts=0, size_t threads=0);
+
+} // namespace libwallet
+
+#endif
+
@@ -28,6 +28,15 @@
 #include <wallet/transaction.hpp>
 #include <wallet/stealth.hpp>
 #include <wallet/uri.hpp>
+#include <wallet/mnemonic_recovery.hpp>
+#include <wallet/bip39.hpp>
+#include <wallet/utxo_pool.hpp>
+#include <wallet/utxo_selector.hpp>
+#include <wallet/address_cache.hpp>
+#include <wallet/base58.hpp>
+#include <wallet/random.hpp>
+#include <wallet/vanity.hpp>
+#include <wallet/address_pool.hpp>
 
 #endif
 
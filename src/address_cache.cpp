@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <wallet/define.hpp>
+#include <wallet/address_cache.hpp>
+
+#include <algorithm>
+#include <functional>
+#include <bitcoin/bitcoin.hpp>
+#include <wallet/base58.hpp>
+
+namespace libwallet {
+
+typedef std::lock_guard<std::mutex> shard_lock;
+
+// Version byte and public key or script hash.
+typedef byte_array<1 + short_hash_size> address_payload;
+
+BCW_API bool decode_address(payment_address& address,
+    const std::string& encoded)
+{
+    address_payload payload;
+    if (!decode_base58check_fixed(encoded, payload))
+        return false;
+    short_hash hash;
+    std::copy(payload.begin() + 1, payload.end(), hash.begin());
+    address.set(payload[0], hash);
+    return true;
+}
+
+BCW_API address_cache::address_cache(size_t capacity, size_t shards)
+  : shard_capacity_(std::max<size_t>(
+        capacity / std::max<size_t>(shards, 1), 1))
+{
+    shards = std::max<size_t>(shards, 1);
+    for (size_t i = 0; i < shards; ++i)
+        shards_.emplace_back(new shard);
+}
+
+address_cache::shard& address_cache::shard_for(
+    const std::string& encoded) const
+{
+    return *shards_[std::hash<std::string>()(encoded) % shards_.size()];
+}
+
+BCW_API bool address_cache::set_encoded(payment_address& address,
+    const std::string& encoded)
+{
+    shard& part = shard_for(encoded);
+    {
+        shard_lock lock(part.mutex);
+        auto it = part.index.find(encoded);
+        if (it != part.index.end())
+        {
+            part.entries.splice(part.entries.begin(), part.entries,
+                it->second);
+            address = it->second->second;
+            return true;
+        }
+    }
+
+    // Decode without holding the lock.
+    payment_address decoded;
+    if (!decode_address(decoded, encoded))
+        return false;
+    address = decoded;
+
+    shard_lock lock(part.mutex);
+    if (part.index.count(encoded))
+        return true;
+    part.entries.emplace_front(encoded, decoded);
+    part.index.emplace(encoded, part.entries.begin());
+    if (part.entries.size() > shard_capacity_)
+    {
+        part.index.erase(part.entries.back().first);
+        part.entries.pop_back();
+    }
+    return true;
+}
+
+BCW_API bool address_cache::contains(const std::string& encoded) const
+{
+    shard& part = shard_for(encoded);
+    shard_lock lock(part.mutex);
+    return part.index.count(encoded) != 0;
+}
+
+BCW_API size_t address_cache::size() const
+{
+    size_t total = 0;
+    for (const auto& part: shards_)
+    {
+        shard_lock lock(part->mutex);
+        total += part->entries.size();
+    }
+    return total;
+}
+
+BCW_API void address_cache::clear()
+{
+    for (const auto& part: shards_)
+    {
+        shard_lock lock(part->mutex);
+        part->index.clear();
+        part->entries.clear();
+    }
+}
+
+} // namespace libwallet
+
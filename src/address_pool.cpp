@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <wallet/define.hpp>
+#include <wallet/address_pool.hpp>
+
+#include <algorithm>
+#include <cstddef>
+#include <bitcoin/bitcoin.hpp>
+
+namespace libwallet {
+
+static size_t round_up_power_of_two(size_t value)
+{
+    size_t result = 2;
+    while (result < value)
+        result <<= 1;
+    return result;
+}
+
+BCW_API address_pool::address_pool(const hd_public_key& key,
+    uint32_t first_index, size_t capacity, size_t low_watermark)
+  : key_(key), capacity_(round_up_power_of_two(capacity)),
+    low_watermark_(low_watermark ?
+        std::min(low_watermark, capacity_) : capacity_ / 2),
+    slots_(new slot[capacity_]), next_index_(first_index),
+    derive_index_(first_index),
+    refill_requested_(true), exhausted_(false), stopping_(false)
+{
+    write_.value = 0;
+    read_.value = 0;
+    for (size_t i = 0; i < capacity_; ++i)
+        slots_[i].sequence.store(i, std::memory_order_relaxed);
+    refill_thread_ = std::thread([this]() { refill(); });
+}
+
+BCW_API address_pool::~address_pool()
+{
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    refill_wanted_.notify_all();
+    refilled_.notify_all();
+    refill_thread_.join();
+}
+
+BCW_API bool address_pool::next_address(issued_address& issued)
+{
+    while (!pop(issued))
+    {
+        // Dry, so wait for the refill thread.
+        std::unique_lock<std::mutex> lock(mutex_);
+        if (stopping_ || (exhausted_ && size() == 0))
+            return false;
+        refill_requested_ = true;
+        refill_wanted_.notify_one();
+        refilled_.wait(lock, [this]()
+        {
+            return stopping_ || exhausted_ || size() != 0;
+        });
+    }
+
+    // Pops complete out of order across threads, so keep the maximum.
+    const uint32_t end = issued.index + 1;
+    uint32_t current = next_index_.load(std::memory_order_relaxed);
+    while (current < end && !next_index_.compare_exchange_weak(
+        current, end, std::memory_order_relaxed))
+        ;
+
+    if (size() < low_watermark_)
+        request_refill();
+    return true;
+}
+
+BCW_API uint32_t address_pool::next_index() const
+{
+    return next_index_.load(std::memory_order_relaxed);
+}
+
+BCW_API size_t address_pool::size() const
+{
+    const size_t read = read_.value.load(std::memory_order_relaxed);
+    const size_t write = write_.value.load(std::memory_order_relaxed);
+    return write > read ? write - read : 0;
+}
+
+bool address_pool::push(const issued_address& value)
+{
+    const size_t mask = capacity_ - 1;
+    size_t position = write_.value.load(std::memory_order_relaxed);
+    while (true)
+    {
+        slot& cell = slots_[position & mask];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        const auto difference = static_cast<ptrdiff_t>(sequence - position);
+        if (difference < 0)
+            return false;
+        if (difference == 0 && write_.value.compare_exchange_weak(
+            position, position + 1, std::memory_order_relaxed))
+        {
+            cell.value = value;
+            cell.sequence.store(position + 1, std::memory_order_release);
+            return true;
+        }
+        if (difference > 0)
+            position = write_.value.load(std::memory_order_relaxed);
+    }
+}
+
+bool address_pool::pop(issued_address& value)
+{
+    const size_t mask = capacity_ - 1;
+    size_t position = read_.value.load(std::memory_order_relaxed);
+    while (true)
+    {
+        slot& cell = slots_[position & mask];
+        const size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        const auto difference =
+            static_cast<ptrdiff_t>(sequence - (position + 1));
+        if (difference < 0)
+            return false;
+        if (difference == 0 && read_.value.compare_exchange_weak(
+            position, position + 1, std::memory_order_relaxed))
+        {
+            value = cell.value;
+            cell.sequence.store(position + capacity_,
+                std::memory_order_release);
+            return true;
+        }
+        if (difference > 0)
+            position = read_.value.load(std::memory_order_relaxed);
+    }
+}
+
+void address_pool::request_refill()
+{
+    // Only the first thread below the watermark takes the lock.
+    if (refill_requested_.load(std::memory_order_relaxed) ||
+        refill_requested_.exchange(true))
+        return;
+    std::lock_guard<std::mutex> lock(mutex_);
+    refill_wanted_.notify_one();
+}
+
+void address_pool::refill()
+{
+    while (true)
+    {
+        {
+            std::unique_lock<std::mutex> lock(mutex_);
+            refill_wanted_.wait(lock, [this]()
+            {
+                return stopping_ || refill_requested_;
+            });
+            if (stopping_)
+                return;
+        }
+
+        // Cleared first, so threads draining the ring meanwhile ask again.
+        refill_requested_ = false;
+        while (key_.valid() && !stopping_ && size() < capacity_ &&
+            derive_index_ < first_hardened_key)
+        {
+            const hd_public_key child =
+                key_.generate_public_key(derive_index_);
+
+            // BIP 32 skips the rare index with no valid key.
+            if (child.valid())
+            {
+                const issued_address value{derive_index_, child.address()};
+                if (!push(value))
+                    break;
+            }
+            ++derive_index_;
+        }
+        if (!key_.valid() || derive_index_ >= first_hardened_key)
+            exhausted_ = true;
+
+        std::lock_guard<std::mutex> lock(mutex_);
+        refilled_.notify_all();
+    }
+}
+
+} // namespace libwallet
+
@@ -0,0 +1,190 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <wallet/define.hpp>
+#include <wallet/base58.hpp>
+
+#include <algorithm>
+#include "sha256.hpp"
+
+namespace libwallet {
+
+static const char* base58_alphabet =
+    "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+// Digit value of each character, or -1 outside the alphabet.
+static const int8_t base58_digits[128] =
+{
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1, -1,
+    -1,  0,  1,  2,  3,  4,  5,  6,  7,  8, -1, -1, -1, -1, -1, -1,
+    -1,  9, 10, 11, 12, 13, 14, 15, 16, -1, 17, 18, 19, 20, 21, -1,
+    22, 23, 24, 25, 26, 27, 28, 29, 30, 31, 32, -1, -1, -1, -1, -1,
+    -1, 33, 34, 35, 36, 37, 38, 39, 40, 41, 42, 43, -1, 44, 45, 46,
+    47, 48, 49, 50, 51, 52, 53, 54, 55, 56, 57, -1, -1, -1, -1, -1
+};
+
+// Five Base58 digits fit in one 32-bit limb.
+constexpr size_t digits_per_limb = 5;
+constexpr uint32_t limb_base = 58 * 58 * 58 * 58 * 58;
+constexpr size_t max_limbs = (base58_max_size + 3) / 4;
+
+BCW_API size_t encode_base58_fixed(const uint8_t* data, size_t size,
+    char* out)
+{
+    if (size > base58_max_size)
+        return 0;
+    const size_t zeros = std::find_if(data, data + size,
+        [](uint8_t byte) { return byte != 0; }) - data;
+
+    // The number as big-endian 32-bit limbs.
+    uint32_t limbs[max_limbs];
+    size_t count = 0;
+    const size_t head = (size - zeros) % 4;
+    const uint8_t* it = data + zeros;
+    if (head)
+    {
+        uint32_t limb = 0;
+        for (size_t i = 0; i < head; ++i)
+            limb = limb << 8 | *it++;
+        limbs[count++] = limb;
+    }
+    for (; it != data + size; it += 4)
+        limbs[count++] = uint32_t(it[0]) << 24 | uint32_t(it[1]) << 16 |
+            uint32_t(it[2]) << 8 | it[3];
+
+    // Divide by 58^5 repeatedly, emitting five digits per remainder,
+    // least significant first.
+    size_t length = 0;
+    size_t first = 0;
+    while (first < count)
+    {
+        uint64_t remainder = 0;
+        for (size_t i = first; i < count; ++i)
+        {
+            const uint64_t value = remainder << 32 | limbs[i];
+            limbs[i] = static_cast<uint32_t>(value / limb_base);
+            remainder = value % limb_base;
+        }
+        while (first < count && limbs[first] == 0)
+            ++first;
+        for (size_t i = 0; i < digits_per_limb; ++i)
+        {
+            // No padding digits after the most significant one.
+            if (first == count && remainder == 0)
+                break;
+            out[length++] = base58_alphabet[remainder % 58];
+            remainder /= 58;
+        }
+    }
+    std::fill(out + length, out + length + zeros, '1');
+    length += zeros;
+    std::reverse(out, out + length);
+    return length;
+}
+
+BCW_API size_t decode_base58_fixed(const char* text, size_t size,
+    uint8_t* out, size_t capacity)
+{
+    if (size == 0)
+        return 0;
+    const size_t ones = std::find_if(text, text + size,
+        [](char c) { return c != '1'; }) - text;
+    if (ones > capacity)
+        return 0;
+
+    // Accumulate five digits at a time into little-endian 32-bit limbs.
+    uint32_t limbs[max_limbs + 1] = {};
+    const size_t max_count = std::min(capacity, base58_max_size) / 4 + 1;
+    size_t count = 0;
+    for (size_t i = ones; i < size;)
+    {
+        uint32_t group = 0;
+        uint32_t scale = 1;
+        for (size_t j = 0; j < digits_per_limb && i < size; ++j, ++i)
+        {
+            const uint8_t c = static_cast<uint8_t>(text[i]);
+            if (c >= 128 || base58_digits[c] < 0)
+                return 0;
+            group = group * 58 + base58_digits[c];
+            scale *= 58;
+        }
+        uint64_t carry = group;
+        for (size_t k = 0; k < count; ++k)
+        {
+            const uint64_t value = uint64_t(limbs[k]) * scale + carry;
+            limbs[k] = static_cast<uint32_t>(value);
+            carry = value >> 32;
+        }
+        if (carry)
+        {
+            if (count == max_count)
+                return 0;
+            limbs[count++] = static_cast<uint32_t>(carry);
+        }
+    }
+
+    // Strip leading zero bytes of the number, then write it out.
+    size_t bytes = count * 4;
+    while (bytes > 0 && (limbs[(bytes - 1) / 4] >> ((bytes - 1) % 4 * 8) &
+        0xff) == 0)
+        --bytes;
+    if (ones + bytes > capacity)
+        return 0;
+    std::fill(out, out + ones, 0);
+    for (size_t i = 0; i < bytes; ++i)
+    {
+        const size_t position = bytes - 1 - i;
+        out[ones + i] = static_cast<uint8_t>(
+            limbs[position / 4] >> (position % 4 * 8));
+    }
+    return ones + bytes;
+}
+
+BCW_API std::string encode_base58check_fixed(const uint8_t* payload,
+    size_t size)
+{
+    uint8_t data[base58_max_size];
+    if (size + 4 > base58_max_size)
+        return std::string();
+    std::copy(payload, payload + size, data);
+    const hash_digest checksum = double_sha256(payload, size);
+    std::copy(checksum.begin(), checksum.begin() + 4, data + size);
+    char out[base58_encoded_size(base58_max_size)];
+    return std::string(out, encode_base58_fixed(data, size + 4, out));
+}
+
+BCW_API bool decode_base58check_fixed(const char* text, size_t text_size,
+    uint8_t* payload, size_t size)
+{
+    uint8_t data[base58_max_size];
+    if (size + 4 > base58_max_size)
+        return false;
+    if (decode_base58_fixed(text, text_size, data, size + 4) != size + 4)
+        return false;
+    const hash_digest checksum = double_sha256(data, size);
+    if (!std::equal(checksum.begin(), checksum.begin() + 4, data + size))
+        return false;
+    std::copy(data, data + size, payload);
+    return true;
+}
+
+} // namespace libwallet
+
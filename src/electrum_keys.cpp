@@ -19,10 +19,6 @@
 #include <wallet/define.hpp>
 #include <wallet/electrum_keys.hpp>
 
-#ifdef _MSC_VER
-#include <random>
-#endif
-
 #ifdef USE_OPENSSL_EC
 #include <openssl/ec.h>
 #endif
@@ -33,6 +29,7 @@
 #include <boost/lexical_cast.hpp>
 #include <boost/algorithm/string.hpp>
 #include <bitcoin/bitcoin.hpp>
+#include <wallet/random.hpp>
 
 namespace libwallet {
 
@@ -102,11 +99,8 @@ const data_chunk bignum_data(BIGNUM* bn)
 
 BCW_API void deterministic_wallet::new_seed()
 {
-    std::random_device random;
-    std::default_random_engine engine(random());
     data_chunk seed(seed_size / 2);
-    for (uint8_t& byte: seed)
-        byte = engine() % std::numeric_limits<uint8_t>::max();
+    random_fill(seed.data(), seed.size());
     BITCOIN_ASSERT(encode_hex(seed).size() == seed_size);
     bool set_success = set_seed(encode_hex(seed));
     BITCOIN_ASSERT(set_success);
@@ -18,7 +18,13 @@
  */
 #include <wallet/define.hpp>
 #include <wallet/hd_keys.hpp>
+
+#include <limits>
 #include <bitcoin/bitcoin.hpp>
+#include <wallet/base58.hpp>
+#include <wallet/random.hpp>
+#include "parallel.hpp"
+#include "sha512.hpp"
 
 namespace libwallet {
 
@@ -28,6 +34,9 @@ constexpr uint32_t testnet_private_prefix = 0x04358394;
 constexpr uint32_t testnet_public_prefix = 0x043587CF;
 constexpr size_t serialized_length = 4 + 1 + 4 + 4 + 32 + 33 + 4;
 
+// Serialized keys without the checksum.
+typedef byte_array<serialized_length - 4> serialized_key;
+
 // long_hash is used for hmac_sha512 in libbitcoin
 constexpr size_t half_long_hash_size = long_hash_size / 2;
 typedef byte_array<half_long_hash_size> half_long_hash;
@@ -49,6 +58,59 @@ static split_long_hash split(const long_hash& hmac)
     return I;
 }
 
+/**
+ * Master keys are HMAC-SHA512 of the seed under "Bitcoin seed", which only
+ * needs absorbing once. Built on first use, so it is ready even for a
+ * master key made during static initialization.
+ */
+static const hmac_sha512_key& master_hmac_key()
+{
+    static const char text[] = "Bitcoin seed";
+    static const hmac_sha512_key key(
+        reinterpret_cast<const uint8_t*>(text), sizeof(text) - 1);
+    return key;
+}
+
+static split_long_hash master_hash(const uint8_t* seed, size_t size)
+{
+    return split(master_hmac_key().hash(seed, size));
+}
+
+// Masters claimed by a worker at a time.
+constexpr size_t master_batch_size = 64;
+
+/**
+ * Serializes a key with the given prefix, where key is the 33 byte
+ * public point or the zero-prefixed secret.
+ */
+static std::string serialize_key(uint32_t prefix,
+    const hd_key_lineage& lineage, const chain_code_type& chain_code,
+    const uint8_t* key)
+{
+    serialized_key data;
+    auto out = data.begin();
+    const auto prefix_bytes = to_big_endian(prefix);
+    out = std::copy(prefix_bytes.begin(), prefix_bytes.end(), out);
+    *out++ = lineage.depth;
+    const auto parent_bytes = to_little_endian(lineage.parent_fingerprint);
+    out = std::copy(parent_bytes.begin(), parent_bytes.end(), out);
+    const auto child_bytes = to_big_endian(lineage.child_number);
+    out = std::copy(child_bytes.begin(), child_bytes.end(), out);
+    out = std::copy(chain_code.begin(), chain_code.end(), out);
+    std::copy(key, key + 33, out);
+    return encode_base58check_fixed(data);
+}
+
+static std::string serialize_secret(uint32_t prefix,
+    const hd_key_lineage& lineage, const chain_code_type& chain_code,
+    const ec_secret& secret)
+{
+    byte_array<33> key;
+    key[0] = 0x00;
+    std::copy(secret.begin(), secret.end(), key.begin() + 1);
+    return serialize_key(prefix, lineage, chain_code, key.data());
+}
+
 BCW_API hd_public_key::hd_public_key()
   : valid_(false)
 {
@@ -82,12 +144,8 @@ BCW_API const hd_key_lineage& hd_public_key::lineage() const
 
 BCW_API bool hd_public_key::set_serialized(std::string encoded)
 {
-    if (!is_base58(encoded))
-        return false;
-    const data_chunk decoded = decode_base58(encoded);
-    if (decoded.size() != serialized_length)
-        return false;
-    if (!verify_checksum(decoded))
+    serialized_key decoded;
+    if (!decode_base58check_fixed(encoded, decoded))
         return false;
 
     auto ds = make_deserializer(decoded.begin(), decoded.end());
@@ -107,21 +165,14 @@ BCW_API bool hd_public_key::set_serialized(std::string encoded)
 
 BCW_API std::string hd_public_key::serialize() const
 {
-    data_chunk data;
-    data.reserve(serialized_length);
+    // Invalid keys have no point, and only compressed points fit.
+    if (K_.size() != ec_compressed_size)
+        return std::string();
+
     auto prefix = mainnet_public_prefix;
     if (lineage_.testnet)
         prefix = testnet_public_prefix;
-
-    extend_data(data, to_big_endian(prefix));
-    data.push_back(lineage_.depth);
-    extend_data(data, to_little_endian(lineage_.parent_fingerprint));
-    extend_data(data, to_big_endian(lineage_.child_number));
-    extend_data(data, c_);
-    extend_data(data, K_);
-
-    append_checksum(data);
-    return encode_base58(data);
+    return serialize_key(prefix, lineage_, c_, K_.data());
 }
 
 BCW_API uint32_t hd_public_key::fingerprint() const
@@ -179,8 +230,7 @@ BCW_API hd_private_key::hd_private_key(const ec_secret& private_key,
 BCW_API hd_private_key::hd_private_key(const data_chunk& seed, bool testnet)
   : hd_public_key()
 {
-    std::string key("Bitcoin seed");
-    split_long_hash I = split(hmac_sha512_hash(seed, to_data_chunk(key)));
+    split_long_hash I = master_hash(seed.data(), seed.size());
 
     // The key is invalid if parse256(IL) >= n or 0:
     if (!verify_private_key(I.L))
@@ -197,12 +247,8 @@ BCW_API const ec_secret& hd_private_key::private_key() const
 
 BCW_API bool hd_private_key::set_serialized(std::string encoded)
 {
-    if (!is_base58(encoded))
-        return false;
-    const data_chunk decoded = decode_base58(encoded);
-    if (decoded.size() != serialized_length)
-        return false;
-    if (!verify_checksum(decoded))
+    serialized_key decoded;
+    if (!decode_base58check_fixed(encoded, decoded))
         return false;
 
     auto ds = make_deserializer(decoded.begin(), decoded.end());
@@ -224,22 +270,10 @@ BCW_API bool hd_private_key::set_serialized(std::string encoded)
 
 BCW_API std::string hd_private_key::serialize() const
 {
-    data_chunk data;
-    data.reserve(4 + 1 + 4 + 4 + 32 + 33 + 4);
     auto prefix = mainnet_private_prefix;
     if (lineage_.testnet)
         prefix = testnet_private_prefix;
-
-    extend_data(data, to_big_endian(prefix));
-    data.push_back(lineage_.depth);
-    extend_data(data, to_little_endian(lineage_.parent_fingerprint));
-    extend_data(data, to_big_endian(lineage_.child_number));
-    extend_data(data, c_);
-    data.push_back(0x00);
-    extend_data(data, k_);
-
-    append_checksum(data);
-    return encode_base58(data);
+    return serialize_secret(prefix, lineage_, c_, k_);
 }
 
 BCW_API hd_private_key hd_private_key::generate_private_key(uint32_t i) const
@@ -282,5 +316,77 @@ BCW_API hd_public_key hd_private_key::generate_public_key(uint32_t i) const
     return generate_private_key(i);
 }
 
+/**
+ * Fills in master from its seed.
+ */
+static void make_master(hd_master_key& master, bool testnet)
+{
+    const split_long_hash I = master_hash(master.seed.data(),
+        master.seed.size());
+    master.valid = verify_private_key(I.L);
+    if (!master.valid)
+        return;
+
+    const hd_key_lineage lineage{testnet, 0, 0, 0};
+    const ec_point K = secret_to_public_key(I.L);
+    master.private_key = serialize_secret(
+        testnet ? testnet_private_prefix : mainnet_private_prefix,
+        lineage, I.R, I.L);
+    master.public_key = serialize_key(
+        testnet ? testnet_public_prefix : mainnet_public_prefix,
+        lineage, I.R, K.data());
+}
+
+static void make_masters(hd_master_key_list& masters, bool testnet,
+    size_t threads)
+{
+    parallel_for(masters.size(), threads, master_batch_size,
+        [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                make_master(masters[i], testnet);
+        });
+}
+
+BCW_API hd_master_key_list generate_hd_masters(
+    const std::vector<data_chunk>& seeds, bool testnet, size_t threads)
+{
+    hd_master_key_list masters(seeds.size());
+    for (size_t i = 0; i < seeds.size(); ++i)
+        masters[i].seed = seeds[i];
+    make_masters(masters, testnet, threads);
+    return masters;
+}
+
+BCW_API hd_master_key_list generate_hd_masters(size_t count,
+    size_t seed_size, bool testnet, size_t threads)
+{
+    if (seed_size < hd_min_seed_size || seed_size > hd_max_seed_size)
+        return hd_master_key_list();
+    if (count > std::numeric_limits<size_t>::max() / seed_size)
+        return hd_master_key_list();
+
+    // Draw every seed in one go rather than one request per key.
+    data_chunk entropy(count * seed_size);
+    random_fill(entropy.data(), entropy.size());
+    hd_master_key_list masters(count);
+    for (size_t i = 0; i < count; ++i)
+    {
+        const auto seed = entropy.begin() + i * seed_size;
+        masters[i].seed.assign(seed, seed + seed_size);
+    }
+    std::fill(entropy.begin(), entropy.end(), 0);
+    make_masters(masters, testnet, threads);
+
+    // An out of range master is vanishingly rare, but replace it anyway.
+    for (hd_master_key& master: masters)
+        while (!master.valid)
+        {
+            random_fill(master.seed.data(), master.seed.size());
+            make_master(master, testnet);
+        }
+    return masters;
+}
+
 } // libwallet
 
@@ -18,70 +18,221 @@
  */
 #include <wallet/key_formats.hpp>
 
+#include <algorithm>
 #include <bitcoin/bitcoin.hpp>
+#include <wallet/base58.hpp>
+#include <wallet/random.hpp>
+#include "parallel.hpp"
+#include "sha256.hpp"
 
 namespace libwallet {
 
+// 1 version byte, 32 byte secret, optional 1 compressed flag, 4 checksum.
+constexpr size_t wif_size = 1 + hash_size + 4;
+constexpr size_t wif_compressed_size = wif_size + 1;
+constexpr uint8_t wif_compressed_flag = 0x01;
+
 std::string secret_to_wif(const ec_secret& secret, bool compressed)
 {
-    data_chunk data;
-    data.reserve(1 + hash_size + 1 + 4);
-
-    data.push_back(payment_address::wif_version);
-    extend_data(data, secret);
+    uint8_t data[wif_compressed_size];
+    data[0] = payment_address::wif_version;
+    std::copy(secret.begin(), secret.end(), data + 1);
+    size_t size = 1 + hash_size;
     if (compressed)
-        data.push_back(0x01);
+        data[size++] = wif_compressed_flag;
+    const hash_digest checksum = double_sha256(data, size);
+    std::copy(checksum.begin(), checksum.begin() + 4, data + size);
+    size += 4;
 
-    append_checksum(data);
-    return encode_base58(data);
+    char encoded[base58_encoded_size(wif_compressed_size)];
+    return std::string(encoded, encode_base58_fixed(data, size, encoded));
 }
 
-ec_secret wif_to_secret(const std::string& wif)
+BCW_API bool decode_wif(const char* wif, size_t size, wif_key& key)
 {
-    if (!is_base58(wif))
-        return ec_secret();
-    data_chunk decoded = decode_base58(wif);
-    // 1 marker, 32 byte secret, optional 1 compressed flag, 4 checksum bytes
-    if (decoded.size() != 1 + hash_size + 4 &&
-        decoded.size() != 1 + hash_size + 1 + 4)
-        return ec_secret();
-    if (!verify_checksum(decoded))
-        return ec_secret();
-    // Check first byte is valid
-    if (decoded[0] != payment_address::wif_version)
-        return ec_secret();
+    key = wif_key();
+    uint8_t data[wif_compressed_size];
+    const size_t decoded = decode_base58_fixed(wif, size, data, sizeof(data));
+    if (decoded != wif_size && decoded != wif_compressed_size)
+        return false;
+
+    const size_t payload = decoded - 4;
+    const hash_digest checksum = double_sha256(data, payload);
+    if (!std::equal(checksum.begin(), checksum.begin() + 4, data + payload))
+        return false;
+    if (data[0] != payment_address::wif_version)
+        return false;
+    const bool compressed = decoded == wif_compressed_size;
+    if (compressed && data[1 + hash_size] != wif_compressed_flag)
+        return false;
+
+    key.version = data[0];
+    std::copy(data + 1, data + 1 + hash_size, key.secret.begin());
+    key.compressed = compressed;
+    key.valid = true;
+    return true;
+}
 
-    // Checks passed. Drop the 0x80 start byte and checksum.
-    decoded.erase(decoded.begin());
-    decoded.erase(decoded.end() - 4, decoded.end());
-    // If length is still 33 and last byte is 0x01, drop it.
-    if (decoded.size() == 33 && decoded[32] == (uint8_t)0x01)
-        decoded.erase(decoded.begin()+32);
-    ec_secret secret;
-    BITCOIN_ASSERT(secret.size() == decoded.size());
-    std::copy(decoded.begin(), decoded.end(), secret.begin());
-    return secret;
+BCW_API wif_key decode_wif(const std::string& wif)
+{
+    wif_key key;
+    decode_wif(wif.data(), wif.size(), key);
+    return key;
 }
 
-bool is_wif_compressed(const std::string& wif) {
-    data_chunk decoded = decode_base58(wif);
-    return decoded.size() == (1 + hash_size + 1 + 4) &&
-        decoded[33] == (uint8_t)0x01;
+ec_secret wif_to_secret(const std::string& wif)
+{
+    return decode_wif(wif).secret;
 }
 
-bool check_minikey(const std::string& minikey)
+bool is_wif_compressed(const std::string& wif)
 {
-    // Legacy minikeys are 22 chars long
-    if (minikey.size() != 22 && minikey.size() != 30)
+    const wif_key key = decode_wif(wif);
+    return key.valid && key.compressed;
+}
+
+// Legacy minikeys are 22 chars long, current ones 30.
+constexpr size_t legacy_minikey_size = 22;
+constexpr size_t minikey_size = 30;
+
+BCW_API bool check_minikey(const char* minikey, size_t size)
+{
+    if (size != legacy_minikey_size && size != minikey_size)
         return false;
-    return sha256_hash(to_data_chunk(minikey + "?"))[0] == 0x00;
+    uint8_t data[minikey_size + 1];
+    std::copy(minikey, minikey + size, data);
+    data[size] = '?';
+    return sha256(data, size + 1)[0] == 0x00;
+}
+
+BCW_API bool check_minikey(const std::string& minikey)
+{
+    return check_minikey(minikey.data(), minikey.size());
 }
 
 ec_secret minikey_to_secret(const std::string& minikey)
 {
     if (!check_minikey(minikey))
         return ec_secret();
-    return sha256_hash(to_data_chunk(minikey));
+    return sha256(reinterpret_cast<const uint8_t*>(minikey.data()),
+        minikey.size());
+}
+
+// Minikeys handed to each worker at a time.
+constexpr size_t minikey_batch_size = 256;
+
+BCW_API std::vector<size_t> validate_minikeys(
+    const std::vector<std::string>& minikeys, size_t threads)
+{
+    std::vector<uint8_t> valid(minikeys.size());
+    parallel_for(minikeys.size(), threads, minikey_batch_size,
+        [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                valid[i] = check_minikey(minikeys[i]);
+        });
+    std::vector<size_t> invalid;
+    for (size_t i = 0; i < valid.size(); ++i)
+        if (!valid[i])
+            invalid.push_back(i);
+    return invalid;
+}
+
+/**
+ * Draws 'S' followed by random Base58 characters until the result is a
+ * valid minikey. About one candidate in 256 passes.
+ */
+static void generate_minikey(char* minikey)
+{
+    const char* alphabet =
+        "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+    uint8_t bytes[minikey_size];
+    size_t available = 0;
+    minikey[0] = 'S';
+    do
+    {
+        for (size_t i = 1; i < minikey_size;)
+        {
+            if (available == 0)
+            {
+                random_fill(bytes, sizeof(bytes));
+                available = sizeof(bytes);
+            }
+            // Reject bytes over 58 * 4 so every character is equally likely.
+            const uint8_t byte = bytes[--available];
+            if (byte < 58 * 4)
+                minikey[i++] = alphabet[byte % 58];
+        }
+    } while (!check_minikey(minikey, minikey_size));
+    std::fill(bytes, bytes + sizeof(bytes), 0);
+}
+
+BCW_API std::vector<std::string> generate_minikeys(size_t count,
+    size_t threads)
+{
+    std::vector<std::string> minikeys(count);
+    parallel_for(count, threads, minikey_batch_size,
+        [&](size_t begin, size_t end)
+        {
+            char minikey[minikey_size];
+            for (size_t i = begin; i < end; ++i)
+            {
+                generate_minikey(minikey);
+                minikeys[i].assign(minikey, minikey_size);
+            }
+        });
+    return minikeys;
+}
+
+// Keys handed to each worker at a time.
+constexpr size_t import_batch_size = 64;
+
+/**
+ * Decodes one WIF or minikey into key, leaving it invalid on failure.
+ */
+static void import_key(const std::string& encoded, imported_key& key)
+{
+    if (!encoded.empty() && encoded[0] == 'S')
+    {
+        if (!check_minikey(encoded))
+            return;
+        key.secret = minikey_to_secret(encoded);
+        key.compressed = false;
+    }
+    else
+    {
+        wif_key wif;
+        if (!decode_wif(encoded.data(), encoded.size(), wif))
+            return;
+        key.secret = wif.secret;
+        key.compressed = wif.compressed;
+    }
+    key.public_key = secret_to_public_key(key.secret, key.compressed);
+    if (key.public_key.empty())
+    {
+        // Not a valid secret for the curve.
+        key = imported_key();
+        return;
+    }
+    key.hash = bitcoin_short_hash(key.public_key);
+    key.valid = true;
+}
+
+BCW_API key_import_result import_keys(const std::vector<std::string>& keys,
+    size_t threads)
+{
+    key_import_result result;
+    result.keys.resize(keys.size());
+    parallel_for(keys.size(), threads, import_batch_size,
+        [&](size_t begin, size_t end)
+        {
+            for (size_t i = begin; i < end; ++i)
+                import_key(keys[i], result.keys[i]);
+        });
+    for (size_t i = 0; i < keys.size(); ++i)
+        if (!result.keys[i].valid)
+            result.invalid.push_back(i);
+    return result;
 }
 
 } // libwallet
@@ -25,6 +25,8 @@
 #include <iostream>
 #endif
 #include <algorithm>
+#include <array>
+#include <cstring>
 #include <sstream>
 #include <bitcoin/bitcoin.hpp>
 
@@ -32,8 +34,10 @@ namespace libwallet {
 
 // List of words from:
 // http://en.wiktionary.org/wiki/Wiktionary:Frequency_lists/Contemporary_poetry
+// Kept as an array of literals so the table lives in read-only data and
+// needs no dynamic initialization when the library is loaded.
 
-string_list common_words{
+static constexpr const char* common_words[] = {
 "like",
 "just",
 "love",
@@ -1662,36 +1666,133 @@ string_list common_words{
 "weary"
 };
 
+constexpr size_t common_words_size =
+    sizeof(common_words) / sizeof(common_words[0]);
+static_assert(common_words_size == mnemonic_word_count,
+    "Electrum word list has 1626 words");
+
+/**
+ * Returns the value of a hex digit, or -1 if c is not a hex digit.
+ */
+static int hex_nibble(const char c)
+{
+    if ('0' <= c && c <= '9')
+        return c - '0';
+    if ('a' <= c && c <= 'f')
+        return 10 + c - 'a';
+    if ('A' <= c && c <= 'F')
+        return 10 + c - 'A';
+    return -1;
+}
+
+BCW_API bool encode_mnemonic(const char* seed, size_t seed_size,
+    mnemonic_index* indexes)
+{
+    const uint32_t n = common_words_size;
+    const char* seed_end = seed + seed_size - seed_size % 8;
+    for (const char* it = seed; it != seed_end; it += 8)
+    {
+        uint32_t val = 0;
+        for (size_t i = 0; i < 8; ++i)
+        {
+            const int nibble = hex_nibble(it[i]);
+            if (nibble < 0)
+                return false;
+            val = val << 4 | nibble;
+        }
+        uint32_t index_1 = val % n;
+        uint32_t index_2 = (val / n + index_1) % n;
+        uint32_t index_3 = ((val / n / n) + index_2) % n;
+        *indexes++ = static_cast<mnemonic_index>(index_1);
+        *indexes++ = static_cast<mnemonic_index>(index_2);
+        *indexes++ = static_cast<mnemonic_index>(index_3);
+    }
+    return true;
+}
+
 BCW_API string_list encode_mnemonic(const std::string& seed)
 {
-    BITCOIN_ASSERT(common_words.size() == 1626);
+    std::vector<mnemonic_index> indexes(seed.size() / 8 * 3);
+    if (!encode_mnemonic(seed.data(), seed.size(), indexes.data()))
+        return string_list();
     string_list result;
-    auto seed_end = seed.end() - seed.size() % 8;
-    for (auto it = seed.begin(); it != seed_end; it += 8)
+    result.reserve(indexes.size());
+    for (mnemonic_index index: indexes)
+        result.push_back(common_words[index]);
+    return result;
+}
+
+BCW_API const char* mnemonic_word(mnemonic_index index)
+{
+    if (index >= common_words_size)
+        return nullptr;
+    return common_words[index];
+}
+
+typedef std::array<uint16_t, common_words_size> word_index_list;
+
+/**
+ * Positions of common_words ordered alphabetically by word, so lookups
+ * can binary search instead of scanning the whole list.
+ */
+static const word_index_list& sorted_word_indexes()
+{
+    static const word_index_list sorted = []()
     {
-        const std::string hex_int(it, it + 8);
-        BITCOIN_ASSERT(hex_int.size() == 8);
-        uint32_t val;
-        std::istringstream ss(hex_int);
-        ss >> std::hex >> val;
-        const size_t n = common_words.size();
-        size_t index_1 = val % n;
-        size_t index_2 = (val / n + index_1) % n;
-        size_t index_3 = ((val / n / n) + index_2) % n;
-        BITCOIN_ASSERT(index_1 < n);
-        result.push_back(common_words[index_1]);
-        BITCOIN_ASSERT(index_2 < n);
-        result.push_back(common_words[index_2]);
-        BITCOIN_ASSERT(index_3 < n);
-        result.push_back(common_words[index_3]);
+        word_index_list indexes;
+        for (size_t i = 0; i < indexes.size(); ++i)
+            indexes[i] = static_cast<uint16_t>(i);
+        std::sort(indexes.begin(), indexes.end(),
+            [](uint16_t index_a, uint16_t index_b)
+            {
+                return std::strcmp(
+                    common_words[index_a], common_words[index_b]) < 0;
+            });
+        return indexes;
+    }();
+    return sorted;
+}
+
+/**
+ * Three-way comparison of a null-terminated list entry against a word
+ * that is not null-terminated, with the same ordering as std::strcmp.
+ */
+static int compare_word(const char* entry, const char* word, size_t size)
+{
+    for (size_t i = 0; i < size; ++i)
+    {
+        const uint8_t a = entry[i], b = word[i];
+        if (a != b || a == '\0')
+            return a < b ? -1 : 1;
     }
-    return result;
+    return entry[size] == '\0' ? 0 : 1;
+}
+
+/**
+ * Returns the position of word in common_words,
+ * or common_words_size if the word is not in the list.
+ */
+static size_t index_of(const char* word, size_t size)
+{
+    const word_index_list& sorted = sorted_word_indexes();
+    auto it = std::lower_bound(sorted.begin(), sorted.end(), word,
+        [size](uint16_t index, const char* word)
+        {
+            return compare_word(common_words[index], word, size) < 0;
+        });
+    if (it == sorted.end() || compare_word(common_words[*it], word, size))
+        return common_words_size;
+    return *it;
 }
 
-size_t index_of(const std::string& word)
+static size_t index_of(const std::string& word)
 {
-    return std::find(common_words.begin(), common_words.end(), word)
-        - common_words.begin();
+    return index_of(word.data(), word.size());
+}
+
+BCW_API size_t mnemonic_word_index(const char* word, size_t size)
+{
+    return index_of(word, size);
 }
 
 uint32_t special_modulo(int u, int v)
@@ -1709,7 +1810,7 @@ BCW_API const std::string decode_mnemonic(const string_list& words)
     ss << std::endl;
     for (auto it = words.begin(); it != words_end; it += 3)
     {
-        const int n = (int)common_words.size();
+        const int n = (int)common_words_size;
         int index_1 = (int)index_of(*it);
         int index_2 = (int)index_of(*(it + 1)) % n;
         int index_3 = (int)index_of(*(it + 2)) % n;
@@ -1721,5 +1822,26 @@ BCW_API const std::string decode_mnemonic(const string_list& words)
     return ss.str();
 }
 
+BCW_API bool decode_mnemonic(const mnemonic_index* indexes, size_t count,
+    char* seed)
+{
+    static const char* hex_digits = "0123456789abcdef";
+    const uint32_t n = common_words_size;
+    const mnemonic_index* indexes_end = indexes + count - count % 3;
+    for (const mnemonic_index* it = indexes; it != indexes_end; it += 3)
+    {
+        if (it[0] >= n || it[1] >= n || it[2] >= n)
+            return false;
+        // Unsigned arithmetic wraps modulo 2^32 like the stream version.
+        uint32_t val = it[0] +
+            n * ((it[1] + n - it[0]) % n) +
+            n * n * ((it[2] + n - it[1]) % n);
+        for (size_t i = 8; i-- > 0; val >>= 4)
+            seed[i] = hex_digits[val & 0x0f];
+        seed += 8;
+    }
+    return true;
+}
+
 } // libwallet
 
@@ -0,0 +1,276 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <wallet/define.hpp>
+#include <wallet/mnemonic_recovery.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <limits>
+#include <mutex>
+#include <thread>
+#include <bitcoin/bitcoin.hpp>
+#include <wallet/electrum_keys.hpp>
+
+namespace libwallet {
+
+// Electrum seeds are 32 hex characters, which is 4 groups of 3 words.
+constexpr size_t recovery_word_count =
+    deterministic_wallet::seed_size / 8 * 3;
+
+// Candidates claimed by a worker at a time.
+constexpr uint64_t recovery_batch_size = 16;
+
+/**
+ * Levenshtein distance between two words.
+ */
+static size_t edit_distance(const std::string& a, const std::string& b)
+{
+    std::vector<size_t> previous(b.size() + 1), current(b.size() + 1);
+    for (size_t j = 0; j <= b.size(); ++j)
+        previous[j] = j;
+    for (size_t i = 1; i <= a.size(); ++i)
+    {
+        current[0] = i;
+        for (size_t j = 1; j <= b.size(); ++j)
+        {
+            const size_t substitute =
+                previous[j - 1] + (a[i - 1] == b[j - 1] ? 0 : 1);
+            current[j] = std::min(substitute,
+                std::min(previous[j], current[j - 1]) + 1);
+        }
+        previous.swap(current);
+    }
+    return previous[b.size()];
+}
+
+/**
+ * Every word in the list, ordered by distance from word (closest first).
+ * If max_distance is nonzero, words further away than that are dropped
+ * unless that would leave no candidates at all.
+ */
+static mnemonic_recovery::index_list nearby_words(
+    const std::string& word, size_t max_distance)
+{
+    std::vector<std::pair<size_t, mnemonic_index>> ranked;
+    ranked.reserve(mnemonic_word_count);
+    for (size_t i = 0; i < mnemonic_word_count; ++i)
+    {
+        const mnemonic_index index = static_cast<mnemonic_index>(i);
+        ranked.emplace_back(edit_distance(word, mnemonic_word(index)), index);
+    }
+    std::stable_sort(ranked.begin(), ranked.end(),
+        [](const std::pair<size_t, mnemonic_index>& a,
+            const std::pair<size_t, mnemonic_index>& b)
+        {
+            return a.first < b.first;
+        });
+
+    // With nothing close enough, any word is as likely as any other.
+    const bool any_word = !max_distance || ranked.front().first > max_distance;
+    mnemonic_recovery::index_list result;
+    for (const auto& entry: ranked)
+    {
+        if (!any_word && entry.first > max_distance)
+            break;
+        result.push_back(entry.second);
+    }
+    return result;
+}
+
+BCW_API mnemonic_recovery::mnemonic_recovery(const string_list& words,
+    size_t max_distance)
+  : stopped_(false)
+{
+    for (const std::string& word: words)
+    {
+        if (word.empty() || word == "?")
+        {
+            // Missing word, any word in the list will do.
+            index_list all(mnemonic_word_count);
+            for (size_t i = 0; i < all.size(); ++i)
+                all[i] = static_cast<mnemonic_index>(i);
+            candidates_.push_back(all);
+            continue;
+        }
+        const size_t index = mnemonic_word_index(word.data(), word.size());
+        if (index < mnemonic_word_count)
+            candidates_.push_back(
+                index_list{static_cast<mnemonic_index>(index)});
+        else
+            candidates_.push_back(nearby_words(word, max_distance));
+    }
+}
+
+BCW_API uint64_t mnemonic_recovery::candidate_count() const
+{
+    if (candidates_.size() != recovery_word_count)
+        return 0;
+    uint64_t total = 1;
+    for (const index_list& position: candidates_)
+    {
+        if (total > std::numeric_limits<uint64_t>::max() / position.size())
+            return std::numeric_limits<uint64_t>::max();
+        total *= position.size();
+    }
+    return total;
+}
+
+BCW_API const std::vector<mnemonic_recovery::index_list>&
+    mnemonic_recovery::candidates() const
+{
+    return candidates_;
+}
+
+void mnemonic_recovery::decode_candidate(
+    uint64_t number, index_list& indexes) const
+{
+    // Mixed radix, with the last position changing fastest so the closest
+    // spellings of early words are tried first.
+    for (size_t i = candidates_.size(); i-- > 0;)
+    {
+        const index_list& position = candidates_[i];
+        indexes[i] = position[number % position.size()];
+        number /= position.size();
+    }
+}
+
+bool mnemonic_recovery::check_candidate(
+    const mnemonic_recovery_target& target, const index_list& indexes) const
+{
+    char seed[deterministic_wallet::seed_size];
+    if (!decode_mnemonic(indexes.data(), indexes.size(), seed))
+        return false;
+    deterministic_wallet wallet;
+    if (!wallet.set_seed(std::string(seed, sizeof(seed))))
+        return false;
+    if (!target.master_public_key.empty())
+        return wallet.master_public_key() == target.master_public_key;
+
+    for (size_t n = 0; n < target.key_count; ++n)
+    {
+        payment_address address;
+        set_public_key(address,
+            wallet.generate_public_key(n, target.for_change));
+        if (address.version() == target.address.version() &&
+            address.hash() == target.address.hash())
+            return true;
+    }
+    return false;
+}
+
+BCW_API bool mnemonic_recovery::recover(
+    const mnemonic_recovery_target& target, string_list& result,
+    mnemonic_recovery_handler handle_progress,
+    size_t threads, double interval_seconds)
+{
+    const uint64_t total = candidate_count();
+    if (total == 0)
+        return false;
+    if (threads == 0)
+        threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+
+    std::atomic<bool> done(false);
+    std::atomic<uint64_t> next(0);
+    std::atomic<uint64_t> tried(0);
+    std::atomic<uint64_t> found(total);
+    std::atomic<size_t> running(threads);
+    std::mutex mutex;
+    std::condition_variable finished;
+
+    auto work = [&]()
+    {
+        index_list indexes(candidates_.size());
+        while (!done && !stopped_)
+        {
+            const uint64_t begin = next.fetch_add(recovery_batch_size);
+            if (begin >= total)
+                break;
+            const uint64_t end =
+                std::min(total, begin + recovery_batch_size);
+            for (uint64_t number = begin; number < end; ++number)
+            {
+                decode_candidate(number, indexes);
+                if (check_candidate(target, indexes))
+                {
+                    found = number;
+                    done = true;
+                    break;
+                }
+            }
+            tried += end - begin;
+        }
+        std::lock_guard<std::mutex> lock(mutex);
+        if (--running == 0)
+            finished.notify_all();
+    };
+
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < threads; ++i)
+        workers.emplace_back(work);
+
+    // Report progress from the calling thread until the workers are done.
+    const auto start = std::chrono::steady_clock::now();
+    auto report = [&]()
+    {
+        if (!handle_progress)
+            return;
+        const std::chrono::duration<double> elapsed =
+            std::chrono::steady_clock::now() - start;
+        mnemonic_recovery_progress progress;
+        progress.tried = std::min(tried.load(), total);
+        progress.total = total;
+        progress.seconds = elapsed.count();
+        progress.rate = progress.seconds > 0 ?
+            progress.tried / progress.seconds : 0;
+        handle_progress(progress);
+    };
+    {
+        const auto interval = std::chrono::duration<double>(interval_seconds);
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!finished.wait_for(lock, interval,
+            [&running]() { return running == 0; }))
+        {
+            lock.unlock();
+            report();
+            lock.lock();
+        }
+    }
+    for (std::thread& worker: workers)
+        worker.join();
+    report();
+
+    if (found == total)
+        return false;
+    index_list indexes(candidates_.size());
+    decode_candidate(found, indexes);
+    result.clear();
+    for (mnemonic_index index: indexes)
+        result.push_back(mnemonic_word(index));
+    return true;
+}
+
+BCW_API void mnemonic_recovery::stop()
+{
+    stopped_ = true;
+}
+
+} // namespace libwallet
+
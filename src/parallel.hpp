@@ -0,0 +1,83 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBWALLET_PARALLEL_HPP
+#define LIBWALLET_PARALLEL_HPP
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <vector>
+
+// Internal header, not installed.
+
+namespace libwallet {
+
+/**
+ * Number of worker threads to use for count items when the caller asked
+ * for threads, where 0 means one per core.
+ */
+inline size_t worker_count(size_t count, size_t threads)
+{
+    if (threads == 0)
+        threads = std::max<size_t>(std::thread::hardware_concurrency(), 1);
+    return std::max<size_t>(std::min(threads, count), 1);
+}
+
+/**
+ * Calls work(begin, end) over [0, count) in batches claimed from a
+ * shared counter by up to threads workers, so uneven items still balance.
+ * Runs on the calling thread alone when one worker is enough.
+ */
+template <typename Work>
+void parallel_for(size_t count, size_t threads, size_t batch_size,
+    Work work)
+{
+    threads = worker_count(count, threads);
+    if (threads == 1)
+    {
+        if (count)
+            work(size_t(0), count);
+        return;
+    }
+
+    std::atomic<size_t> next(0);
+    auto run = [&]()
+    {
+        while (true)
+        {
+            const size_t begin = next.fetch_add(batch_size);
+            if (begin >= count)
+                break;
+            work(begin, std::min(count, begin + batch_size));
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 1; i < threads; ++i)
+        workers.emplace_back(run);
+    run();
+    for (std::thread& worker: workers)
+        worker.join();
+}
+
+} // namespace libwallet
+
+#endif
+
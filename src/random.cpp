@@ -0,0 +1,273 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <wallet/define.hpp>
+#include <wallet/random.hpp>
+
+#include <algorithm>
+#include <cstdlib>
+#include <bitcoin/bitcoin.hpp>
+
+#ifdef _WIN32
+    #include <windows.h>
+    // RtlGenRandom, which needs no crypto provider context.
+    #define SystemFunction036 NTAPI SystemFunction036
+    #include <ntsecapi.h>
+    #undef SystemFunction036
+    #pragma comment(lib, "advapi32.lib")
+#else
+    #include <cerrno>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #ifdef __linux__
+        #include <sys/syscall.h>
+    #endif
+#endif
+
+// Visual Studio 2013 has no thread_local, but the state here is plain data.
+#if defined(_MSC_VER) && _MSC_VER < 1900
+    #define BCW_THREAD_LOCAL __declspec(thread)
+#else
+    #define BCW_THREAD_LOCAL thread_local
+#endif
+
+namespace libwallet {
+
+#ifdef _WIN32
+
+BCW_API bool system_random_fill(uint8_t* data, size_t size)
+{
+    while (size > 0)
+    {
+        const ULONG chunk = static_cast<ULONG>(
+            std::min<size_t>(size, 1 << 20));
+        if (!RtlGenRandom(data, chunk))
+            return false;
+        data += chunk;
+        size -= chunk;
+    }
+    return true;
+}
+
+static uint32_t process_id()
+{
+    // No fork() to worry about.
+    return 0;
+}
+
+#else
+
+static bool read_urandom(uint8_t* data, size_t size)
+{
+    const int file = open("/dev/urandom", O_RDONLY);
+    if (file < 0)
+        return false;
+    while (size > 0)
+    {
+        const ssize_t result = read(file, data, size);
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result <= 0)
+        {
+            close(file);
+            return false;
+        }
+        data += result;
+        size -= result;
+    }
+    close(file);
+    return true;
+}
+
+BCW_API bool system_random_fill(uint8_t* data, size_t size)
+{
+#if defined(__linux__) && defined(SYS_getrandom)
+    while (size > 0)
+    {
+        const long result = syscall(SYS_getrandom, data, size, 0);
+        if (result < 0 && errno == EINTR)
+            continue;
+        if (result < 0 && errno == ENOSYS)
+            return read_urandom(data, size);
+        if (result <= 0)
+            return false;
+        data += result;
+        size -= result;
+    }
+    return true;
+#else
+    return read_urandom(data, size);
+#endif
+}
+
+static uint32_t process_id()
+{
+    return static_cast<uint32_t>(getpid());
+}
+
+#endif
+
+// Blocks generated per refill. The first key size bytes of each refill
+// become the next key, so earlier output cannot be recovered from the
+// state.
+constexpr size_t chacha_refill_blocks = 16;
+constexpr size_t chacha_buffer_size =
+    chacha_refill_blocks * chacha20_block_size;
+
+// Bytes served before mixing in fresh system entropy.
+constexpr uint64_t chacha_reseed_bytes = 1 << 24;
+
+static inline uint32_t rotate(uint32_t x, unsigned n)
+{
+    return (x << n) | (x >> (32 - n));
+}
+
+static inline uint32_t read_word(const uint8_t* data)
+{
+    return uint32_t(data[0]) | uint32_t(data[1]) << 8 |
+        uint32_t(data[2]) << 16 | uint32_t(data[3]) << 24;
+}
+
+static inline void write_word(uint8_t* data, uint32_t word)
+{
+    for (size_t i = 0; i < 4; ++i, word >>= 8)
+        data[i] = static_cast<uint8_t>(word);
+}
+
+#define CHACHA_QUARTER_ROUND(a, b, c, d) \
+    a += b; d = rotate(d ^ a, 16); \
+    c += d; b = rotate(b ^ c, 12); \
+    a += b; d = rotate(d ^ a, 8); \
+    c += d; b = rotate(b ^ c, 7);
+
+BCW_API void chacha20_block(const uint8_t* key, uint64_t counter,
+    uint8_t* out)
+{
+    uint32_t input[16] =
+    {
+        0x61707865, 0x3320646e, 0x79622d32, 0x6b206574
+    };
+    for (size_t i = 0; i < 8; ++i)
+        input[4 + i] = read_word(key + 4 * i);
+    input[12] = static_cast<uint32_t>(counter);
+    input[13] = static_cast<uint32_t>(counter >> 32);
+    input[14] = 0;
+    input[15] = 0;
+
+    uint32_t x[16];
+    std::copy(input, input + 16, x);
+    for (size_t round = 0; round < 10; ++round)
+    {
+        CHACHA_QUARTER_ROUND(x[0], x[4], x[8], x[12])
+        CHACHA_QUARTER_ROUND(x[1], x[5], x[9], x[13])
+        CHACHA_QUARTER_ROUND(x[2], x[6], x[10], x[14])
+        CHACHA_QUARTER_ROUND(x[3], x[7], x[11], x[15])
+        CHACHA_QUARTER_ROUND(x[0], x[5], x[10], x[15])
+        CHACHA_QUARTER_ROUND(x[1], x[6], x[11], x[12])
+        CHACHA_QUARTER_ROUND(x[2], x[7], x[8], x[13])
+        CHACHA_QUARTER_ROUND(x[3], x[4], x[9], x[14])
+    }
+    for (size_t i = 0; i < 16; ++i)
+        write_word(out + 4 * i, x[i] + input[i]);
+}
+
+#undef CHACHA_QUARTER_ROUND
+
+/**
+ * Per-thread generator. Plain data so it can live in thread storage on
+ * every compiler, zeroed until first use.
+ */
+struct chacha_state
+{
+    bool seeded;
+    uint32_t pid;
+    uint64_t served;
+    size_t position;
+    uint8_t key[chacha20_key_size];
+    uint8_t buffer[chacha_buffer_size];
+};
+
+static BCW_THREAD_LOCAL chacha_state thread_state;
+
+static void secure_abort()
+{
+    // A failed system source must never turn into predictable keys.
+    std::abort();
+}
+
+static void reseed(chacha_state& state)
+{
+    uint8_t fresh[chacha20_key_size];
+    if (!system_random_fill(fresh, sizeof(fresh)))
+        secure_abort();
+    // Mix rather than replace, so a weak read cannot lower the strength.
+    for (size_t i = 0; i < chacha20_key_size; ++i)
+        state.key[i] ^= fresh[i];
+    std::fill(fresh, fresh + sizeof(fresh), 0);
+    state.seeded = true;
+    state.pid = process_id();
+    state.served = 0;
+    state.position = chacha_buffer_size;
+}
+
+static void refill(chacha_state& state)
+{
+    for (size_t i = 0; i < chacha_refill_blocks; ++i)
+        chacha20_block(state.key, i, state.buffer + i * chacha20_block_size);
+    std::copy(state.buffer, state.buffer + chacha20_key_size, state.key);
+    std::fill(state.buffer, state.buffer + chacha20_key_size, 0);
+    state.position = chacha20_key_size;
+}
+
+BCW_API void random_fill(uint8_t* data, size_t size)
+{
+    chacha_state& state = thread_state;
+    if (!state.seeded || state.pid != process_id() ||
+        state.served >= chacha_reseed_bytes)
+        reseed(state);
+
+    while (size > 0)
+    {
+        if (state.position == chacha_buffer_size)
+            refill(state);
+        const size_t count = std::min(size,
+            chacha_buffer_size - state.position);
+        uint8_t* begin = state.buffer + state.position;
+        std::copy(begin, begin + count, data);
+        // Served bytes are wiped so they cannot be read back later.
+        std::fill(begin, begin + count, 0);
+        state.position += count;
+        state.served += count;
+        data += count;
+        size -= count;
+    }
+}
+
+BCW_API ec_secret new_secret()
+{
+    // Nearly every 32 byte string is below the curve order.
+    ec_secret secret;
+    do
+        random_fill(secret.data(), secret.size());
+    while (!verify_private_key(secret));
+    return secret;
+}
+
+} // namespace libwallet
+
@@ -0,0 +1,82 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBWALLET_SELECT_OUTPUTS_HPP
+#define LIBWALLET_SELECT_OUTPUTS_HPP
+
+#include <cstdint>
+#include <vector>
+#include <wallet/define.hpp>
+#include <wallet/transaction.hpp>
+
+// Internal header, not installed.
+
+namespace libwallet {
+
+typedef std::vector<uint64_t> value_list;
+typedef std::vector<size_t> index_list;
+
+/**
+ * Runs a selection algorithm over a list of values, appending the
+ * positions of the chosen values to selected. The values are not
+ * reordered. branch_and_bound accepts totals up to target + tolerance.
+ * Returns false if no selection reaching target was found.
+ */
+BCW_INTERNAL bool select_indexes(const value_list& values, uint64_t target,
+    uint64_t tolerance, select_outputs_algorithm alg, size_t max_iterations,
+    index_list& selected);
+
+/**
+ * A select_outputs_fee model turned into amounts.
+ */
+struct selection_costs
+{
+    // Fee for spending one input.
+    uint64_t input;
+    // Fee for everything but the inputs and change.
+    uint64_t base;
+    // Fee for the change output.
+    uint64_t change;
+    // Excess below this goes to the fee instead of a change output.
+    uint64_t min_change;
+};
+
+BCW_INTERNAL selection_costs get_costs(const select_outputs_fee& fee);
+
+/**
+ * The branch_and_bound tolerance: the largest excess that still needs no
+ * change output. Without a minimum change any excess is change.
+ */
+inline uint64_t change_free_excess(const selection_costs& costs)
+{
+    return costs.min_change ? costs.min_change - 1 : 0;
+}
+
+/**
+ * Fills in change and fee for inputs whose effective values add up to
+ * effective_total, which must be at least min_value + costs.base.
+ */
+BCW_INTERNAL void set_change_and_fee(select_outputs_result& result,
+    const selection_costs& costs, uint64_t min_value,
+    uint64_t effective_total);
+
+} // namespace libwallet
+
+#endif
+
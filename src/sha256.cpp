@@ -0,0 +1,132 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sha256.hpp"
+
+#include <algorithm>
+
+namespace libwallet {
+
+static const uint32_t initial_state[8] =
+{
+    0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a,
+    0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19
+};
+
+static const uint32_t round_constants[64] =
+{
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2
+};
+
+static inline uint32_t rotate(uint32_t x, unsigned n)
+{
+    return (x >> n) | (x << (32 - n));
+}
+
+static inline uint32_t read_word(const uint8_t* data)
+{
+    return uint32_t(data[0]) << 24 | uint32_t(data[1]) << 16 |
+        uint32_t(data[2]) << 8 | data[3];
+}
+
+static inline void write_word(uint8_t* data, uint32_t word)
+{
+    for (size_t i = 4; i-- > 0; word >>= 8)
+        data[i] = static_cast<uint8_t>(word);
+}
+
+/**
+ * Runs the SHA-256 compression function over one 64 byte block.
+ */
+static void compress(uint32_t state[8], const uint8_t* data)
+{
+    uint32_t w[64];
+    for (size_t i = 0; i < 16; ++i)
+        w[i] = read_word(data + 4 * i);
+    for (size_t i = 16; i < 64; ++i)
+    {
+        const uint32_t s0 =
+            rotate(w[i - 15], 7) ^ rotate(w[i - 15], 18) ^ (w[i - 15] >> 3);
+        const uint32_t s1 =
+            rotate(w[i - 2], 17) ^ rotate(w[i - 2], 19) ^ (w[i - 2] >> 10);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint32_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint32_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (size_t i = 0; i < 64; ++i)
+    {
+        const uint32_t s1 = rotate(e, 6) ^ rotate(e, 11) ^ rotate(e, 25);
+        const uint32_t choice = (e & f) ^ (~e & g);
+        const uint32_t t1 = h + s1 + choice + round_constants[i] + w[i];
+        const uint32_t s0 = rotate(a, 2) ^ rotate(a, 13) ^ rotate(a, 22);
+        const uint32_t majority = (a & b) ^ (a & c) ^ (b & c);
+        const uint32_t t2 = s0 + majority;
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+BCW_INTERNAL hash_digest sha256(const uint8_t* data, size_t size)
+{
+    uint32_t state[8];
+    std::copy(initial_state, initial_state + 8, state);
+    const uint8_t* end = data + size - size % sha256_block_size;
+    for (; data != end; data += sha256_block_size)
+        compress(state, data);
+
+    uint8_t tail[2 * sha256_block_size] = {};
+    const size_t remainder = size % sha256_block_size;
+    std::copy(data, data + remainder, tail);
+    tail[remainder] = 0x80;
+    const size_t tail_size = remainder < sha256_block_size - 8 ?
+        sha256_block_size : 2 * sha256_block_size;
+    const uint64_t bits = uint64_t(size) * 8;
+    write_word(tail + tail_size - 8, static_cast<uint32_t>(bits >> 32));
+    write_word(tail + tail_size - 4, static_cast<uint32_t>(bits));
+    compress(state, tail);
+    if (tail_size > sha256_block_size)
+        compress(state, tail + sha256_block_size);
+
+    hash_digest result;
+    for (size_t i = 0; i < 8; ++i)
+        write_word(result.data() + 4 * i, state[i]);
+    return result;
+}
+
+BCW_INTERNAL hash_digest double_sha256(const uint8_t* data, size_t size)
+{
+    const hash_digest first = sha256(data, size);
+    return sha256(first.data(), first.size());
+}
+
+} // namespace libwallet
+
@@ -0,0 +1,50 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBWALLET_SHA256_HPP
+#define LIBWALLET_SHA256_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/types.hpp>
+#include <wallet/define.hpp>
+
+// Internal header, not installed.
+
+namespace libwallet {
+
+using namespace libbitcoin;
+
+constexpr size_t sha256_block_size = 64;
+
+/**
+ * SHA-256 of a buffer, without copying it into a data_chunk first.
+ */
+BCW_INTERNAL hash_digest sha256(const uint8_t* data, size_t size);
+
+/**
+ * SHA-256 applied twice, as used for Base58Check checksums.
+ * Bytes are in hash order, so the checksum is the first four.
+ */
+BCW_INTERNAL hash_digest double_sha256(const uint8_t* data, size_t size);
+
+} // namespace libwallet
+
+#endif
+
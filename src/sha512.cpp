@@ -0,0 +1,250 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include "sha512.hpp"
+
+#include <algorithm>
+
+namespace libwallet {
+
+static const uint64_t initial_state[8] =
+{
+    0x6a09e667f3bcc908ULL, 0xbb67ae8584caa73bULL,
+    0x3c6ef372fe94f82bULL, 0xa54ff53a5f1d36f1ULL,
+    0x510e527fade682d1ULL, 0x9b05688c2b3e6c1fULL,
+    0x1f83d9abfb41bd6bULL, 0x5be0cd19137e2179ULL
+};
+
+static const uint64_t round_constants[80] =
+{
+    0x428a2f98d728ae22ULL, 0x7137449123ef65cdULL, 0xb5c0fbcfec4d3b2fULL,
+    0xe9b5dba58189dbbcULL, 0x3956c25bf348b538ULL, 0x59f111f1b605d019ULL,
+    0x923f82a4af194f9bULL, 0xab1c5ed5da6d8118ULL, 0xd807aa98a3030242ULL,
+    0x12835b0145706fbeULL, 0x243185be4ee4b28cULL, 0x550c7dc3d5ffb4e2ULL,
+    0x72be5d74f27b896fULL, 0x80deb1fe3b1696b1ULL, 0x9bdc06a725c71235ULL,
+    0xc19bf174cf692694ULL, 0xe49b69c19ef14ad2ULL, 0xefbe4786384f25e3ULL,
+    0x0fc19dc68b8cd5b5ULL, 0x240ca1cc77ac9c65ULL, 0x2de92c6f592b0275ULL,
+    0x4a7484aa6ea6e483ULL, 0x5cb0a9dcbd41fbd4ULL, 0x76f988da831153b5ULL,
+    0x983e5152ee66dfabULL, 0xa831c66d2db43210ULL, 0xb00327c898fb213fULL,
+    0xbf597fc7beef0ee4ULL, 0xc6e00bf33da88fc2ULL, 0xd5a79147930aa725ULL,
+    0x06ca6351e003826fULL, 0x142929670a0e6e70ULL, 0x27b70a8546d22ffcULL,
+    0x2e1b21385c26c926ULL, 0x4d2c6dfc5ac42aedULL, 0x53380d139d95b3dfULL,
+    0x650a73548baf63deULL, 0x766a0abb3c77b2a8ULL, 0x81c2c92e47edaee6ULL,
+    0x92722c851482353bULL, 0xa2bfe8a14cf10364ULL, 0xa81a664bbc423001ULL,
+    0xc24b8b70d0f89791ULL, 0xc76c51a30654be30ULL, 0xd192e819d6ef5218ULL,
+    0xd69906245565a910ULL, 0xf40e35855771202aULL, 0x106aa07032bbd1b8ULL,
+    0x19a4c116b8d2d0c8ULL, 0x1e376c085141ab53ULL, 0x2748774cdf8eeb99ULL,
+    0x34b0bcb5e19b48a8ULL, 0x391c0cb3c5c95a63ULL, 0x4ed8aa4ae3418acbULL,
+    0x5b9cca4f7763e373ULL, 0x682e6ff3d6b2b8a3ULL, 0x748f82ee5defb2fcULL,
+    0x78a5636f43172f60ULL, 0x84c87814a1f0ab72ULL, 0x8cc702081a6439ecULL,
+    0x90befffa23631e28ULL, 0xa4506cebde82bde9ULL, 0xbef9a3f7b2c67915ULL,
+    0xc67178f2e372532bULL, 0xca273eceea26619cULL, 0xd186b8c721c0c207ULL,
+    0xeada7dd6cde0eb1eULL, 0xf57d4f7fee6ed178ULL, 0x06f067aa72176fbaULL,
+    0x0a637dc5a2c898a6ULL, 0x113f9804bef90daeULL, 0x1b710b35131c471bULL,
+    0x28db77f523047d84ULL, 0x32caab7b40c72493ULL, 0x3c9ebe0a15c9bebcULL,
+    0x431d67c49c100d4cULL, 0x4cc5d4becb3e42b6ULL, 0x597f299cfc657e2aULL,
+    0x5fcb6fab3ad6faecULL, 0x6c44198c4a475817ULL
+};
+
+static inline uint64_t rotate(uint64_t x, unsigned n)
+{
+    return (x >> n) | (x << (64 - n));
+}
+
+static inline uint64_t read_word(const uint8_t* data)
+{
+    uint64_t word = 0;
+    for (size_t i = 0; i < 8; ++i)
+        word = word << 8 | data[i];
+    return word;
+}
+
+static inline void write_word(uint8_t* data, uint64_t word)
+{
+    for (size_t i = 8; i-- > 0; word >>= 8)
+        data[i] = static_cast<uint8_t>(word);
+}
+
+/**
+ * Runs the SHA-512 compression function over one block given as 16
+ * big-endian words.
+ */
+static void compress(uint64_t state[8], const uint64_t block[16])
+{
+    uint64_t w[80];
+    std::copy(block, block + 16, w);
+    for (size_t i = 16; i < 80; ++i)
+    {
+        const uint64_t s0 =
+            rotate(w[i - 15], 1) ^ rotate(w[i - 15], 8) ^ (w[i - 15] >> 7);
+        const uint64_t s1 =
+            rotate(w[i - 2], 19) ^ rotate(w[i - 2], 61) ^ (w[i - 2] >> 6);
+        w[i] = w[i - 16] + s0 + w[i - 7] + s1;
+    }
+
+    uint64_t a = state[0], b = state[1], c = state[2], d = state[3];
+    uint64_t e = state[4], f = state[5], g = state[6], h = state[7];
+    for (size_t i = 0; i < 80; ++i)
+    {
+        const uint64_t s1 = rotate(e, 14) ^ rotate(e, 18) ^ rotate(e, 41);
+        const uint64_t choice = (e & f) ^ (~e & g);
+        const uint64_t t1 = h + s1 + choice + round_constants[i] + w[i];
+        const uint64_t s0 = rotate(a, 28) ^ rotate(a, 34) ^ rotate(a, 39);
+        const uint64_t majority = (a & b) ^ (a & c) ^ (b & c);
+        const uint64_t t2 = s0 + majority;
+        h = g; g = f; f = e; e = d + t1;
+        d = c; c = b; b = a; a = t1 + t2;
+    }
+    state[0] += a; state[1] += b; state[2] += c; state[3] += d;
+    state[4] += e; state[5] += f; state[6] += g; state[7] += h;
+}
+
+static void compress_bytes(uint64_t state[8], const uint8_t* data)
+{
+    uint64_t block[16];
+    for (size_t i = 0; i < 16; ++i)
+        block[i] = read_word(data + 8 * i);
+    compress(state, block);
+}
+
+/**
+ * Hashes data into state, which has already absorbed prefix_size bytes,
+ * and applies the final padding.
+ */
+static void finish(uint64_t state[8], size_t prefix_size,
+    const uint8_t* data, size_t size)
+{
+    const uint8_t* end = data + size - size % sha512_block_size;
+    for (; data != end; data += sha512_block_size)
+        compress_bytes(state, data);
+
+    uint8_t tail[2 * sha512_block_size] = {};
+    const size_t remainder = size % sha512_block_size;
+    std::copy(data, data + remainder, tail);
+    tail[remainder] = 0x80;
+    const size_t tail_size = remainder < sha512_block_size - 16 ?
+        sha512_block_size : 2 * sha512_block_size;
+    // Message length in bits, the upper 64 bits are always zero here.
+    write_word(tail + tail_size - 8, (prefix_size + size) * 8);
+    compress_bytes(state, tail);
+    if (tail_size > sha512_block_size)
+        compress_bytes(state, tail + sha512_block_size);
+}
+
+BCW_INTERNAL hmac_sha512_key::hmac_sha512_key(const uint8_t* key, size_t size)
+{
+    uint8_t padded[sha512_block_size] = {};
+    if (size > sha512_block_size)
+    {
+        uint64_t digest[8];
+        std::copy(initial_state, initial_state + 8, digest);
+        finish(digest, 0, key, size);
+        for (size_t i = 0; i < 8; ++i)
+            write_word(padded + 8 * i, digest[i]);
+    }
+    else
+        std::copy(key, key + size, padded);
+
+    uint8_t block[sha512_block_size];
+    for (size_t i = 0; i < sha512_block_size; ++i)
+        block[i] = padded[i] ^ 0x36;
+    std::copy(initial_state, initial_state + 8, inner_);
+    compress_bytes(inner_, block);
+
+    for (size_t i = 0; i < sha512_block_size; ++i)
+        block[i] = padded[i] ^ 0x5c;
+    std::copy(initial_state, initial_state + 8, outer_);
+    compress_bytes(outer_, block);
+}
+
+/**
+ * Completes the outer hash over an inner digest, in place.
+ */
+static void finish_outer(const uint64_t outer[8], uint64_t digest[8])
+{
+    // digest || 0x80 || zeros || length of (key block + digest) in bits.
+    uint64_t block[16] = {};
+    std::copy(digest, digest + 8, block);
+    block[8] = 0x8000000000000000ULL;
+    block[15] = (sha512_block_size + 64) * 8;
+    std::copy(outer, outer + 8, digest);
+    compress(digest, block);
+}
+
+BCW_INTERNAL long_hash hmac_sha512_key::hash(
+    const uint8_t* data, size_t size) const
+{
+    uint64_t digest[8];
+    std::copy(inner_, inner_ + 8, digest);
+    finish(digest, sha512_block_size, data, size);
+    finish_outer(outer_, digest);
+
+    long_hash result;
+    for (size_t i = 0; i < 8; ++i)
+        write_word(result.data() + 8 * i, digest[i]);
+    return result;
+}
+
+BCW_INTERNAL void hmac_sha512_key::pbkdf2(const uint8_t* salt,
+    size_t salt_size, size_t iterations, uint8_t* out, size_t out_size) const
+{
+    // Every iteration after the first hashes a 64 byte digest, which
+    // always pads to the same single block. Keep it as words and only
+    // refill the first 8 of them.
+    uint64_t block[16] = {};
+    block[8] = 0x8000000000000000ULL;
+    block[15] = (sha512_block_size + 64) * 8;
+
+    data_chunk first(salt, salt + salt_size);
+    first.resize(salt_size + 4);
+    for (uint32_t counter = 1; out_size > 0; ++counter)
+    {
+        first[salt_size + 0] = static_cast<uint8_t>(counter >> 24);
+        first[salt_size + 1] = static_cast<uint8_t>(counter >> 16);
+        first[salt_size + 2] = static_cast<uint8_t>(counter >> 8);
+        first[salt_size + 3] = static_cast<uint8_t>(counter);
+
+        uint64_t digest[8], result[8];
+        std::copy(inner_, inner_ + 8, digest);
+        finish(digest, sha512_block_size, first.data(), first.size());
+        finish_outer(outer_, digest);
+        std::copy(digest, digest + 8, result);
+
+        for (size_t i = 1; i < iterations; ++i)
+        {
+            std::copy(digest, digest + 8, block);
+            std::copy(inner_, inner_ + 8, digest);
+            compress(digest, block);
+            finish_outer(outer_, digest);
+            for (size_t j = 0; j < 8; ++j)
+                result[j] ^= digest[j];
+        }
+
+        uint8_t bytes[64];
+        for (size_t j = 0; j < 8; ++j)
+            write_word(bytes + 8 * j, result[j]);
+        const size_t copy_size = std::min(out_size, sizeof(bytes));
+        std::copy(bytes, bytes + copy_size, out);
+        out += copy_size;
+        out_size -= copy_size;
+    }
+}
+
+} // namespace libwallet
+
@@ -0,0 +1,63 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef LIBWALLET_SHA512_HPP
+#define LIBWALLET_SHA512_HPP
+
+#include <cstddef>
+#include <cstdint>
+#include <bitcoin/types.hpp>
+#include <wallet/define.hpp>
+
+// Internal header, not installed.
+
+namespace libwallet {
+
+using namespace libbitcoin;
+
+constexpr size_t sha512_block_size = 128;
+
+/**
+ * HMAC-SHA512 with the padded key already absorbed into the inner and
+ * outer hash states. Reusing one of these saves two compressions per
+ * message compared with hmac_sha512_hash(), which rebuilds them.
+ */
+class hmac_sha512_key
+{
+public:
+    BCW_INTERNAL hmac_sha512_key(const uint8_t* key, size_t size);
+
+    BCW_INTERNAL long_hash hash(const uint8_t* data, size_t size) const;
+
+    /**
+     * Fills out with PBKDF2 (RFC 2898) output using this key as the
+     * password.
+     */
+    BCW_INTERNAL void pbkdf2(const uint8_t* salt, size_t salt_size,
+        size_t iterations, uint8_t* out, size_t out_size) const;
+
+private:
+    uint64_t inner_[8];
+    uint64_t outer_[8];
+};
+
+} // namespace libwallet
+
+#endif
+
@@ -18,11 +18,14 @@
  */
 #include <wallet/stealth.hpp>
 
+#include <algorithm>
 #include <bitcoin/utility/assert.hpp>
 #include <bitcoin/utility/base58.hpp>
 #include <bitcoin/utility/checksum.hpp>
 #include <bitcoin/utility/hash.hpp>
 #include <bitcoin/format.hpp>
+#include <wallet/base58.hpp>
+#include "sha256.hpp"
 
 namespace libwallet {
 
@@ -30,13 +33,33 @@ constexpr uint8_t stealth_version_byte = 0x2a;
 
 BCW_API bool stealth_address::set_encoded(const std::string& encoded_address)
 {
-    data_chunk raw_addr = decode_base58(encoded_address);
-    if (!verify_checksum(raw_addr))
-        return false;
-    BITCOIN_ASSERT(raw_addr.size() >= 4);
-    auto checksum_begin = raw_addr.end() - 4;
-    // Delete checksum bytes.
-    raw_addr.erase(checksum_begin, raw_addr.end());
+    data_chunk raw_addr;
+    // Most stealth addresses fit the fixed-size decoder, but the longest
+    // strings it accepts can still decode to more than it holds.
+    uint8_t decoded[base58_max_size];
+    size_t size = 0;
+    if (encoded_address.size() <= base58_encoded_size(base58_max_size))
+        size = decode_base58_fixed(encoded_address.data(),
+            encoded_address.size(), decoded, sizeof(decoded));
+    if (size != 0)
+    {
+        if (size < 4)
+            return false;
+        const hash_digest checksum = double_sha256(decoded, size - 4);
+        if (!std::equal(checksum.begin(), checksum.begin() + 4,
+            decoded + size - 4))
+            return false;
+        raw_addr.assign(decoded, decoded + size - 4);
+    }
+    else
+    {
+        raw_addr = decode_base58(encoded_address);
+        if (raw_addr.size() < 4 || !verify_checksum(raw_addr))
+            return false;
+        auto checksum_begin = raw_addr.end() - 4;
+        // Delete checksum bytes.
+        raw_addr.erase(checksum_begin, raw_addr.end());
+    }
     // https://wiki.unsystem.net/index.php/DarkWallet/Stealth#Address_format
     // [version] [options] [scan_key] [N] ... [Nsigs] [prefix_length] ...
     size_t estimated_data_size = 1 + 1 + 33 + 1 + 1 + 1;
@@ -88,6 +111,8 @@ BCW_API std::string stealth_address::encoded() const
     raw_addr.push_back(number_signatures);
     BITCOIN_ASSERT_MSG(prefix.number_bits == 0, "Not yet implemented!");
     raw_addr.push_back(0);
+    if (raw_addr.size() + 4 <= base58_max_size)
+        return encode_base58check_fixed(raw_addr.data(), raw_addr.size());
     append_checksum(raw_addr);
     return encode_base58(raw_addr);
 }
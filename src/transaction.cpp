@@ -19,61 +19,406 @@
 #include <wallet/define.hpp>
 #include <wallet/transaction.hpp>
 
+#include <algorithm>
+#include <limits>
+#include <random>
 #include <bitcoin/bitcoin.hpp>
+#include "select_outputs.hpp"
 
 namespace libwallet {
 
-BCW_API select_outputs_result select_outputs(
-    output_info_list unspent, uint64_t min_value,
-    select_outputs_algorithm alg)
+/**
+ * The selection algorithms below work on a list of values and return
+ * positions in it, so the caller's outputs are never reordered.
+ * Each returns false if no selection reaching target was found.
+ */
+
+static index_list all_indexes(const value_list& values)
 {
-    // Just one default implementation for now.
-    // Consider a switch case with greedy_select_outputs(min_value) .etc
-    // if this is ever extended with more algorithms.
-    BITCOIN_ASSERT(alg == select_outputs_algorithm::greedy);
-    // Fail if empty.
-    if (unspent.empty())
-        return select_outputs_result();
-    auto lesser_begin = unspent.begin();
-    auto lesser_end = std::partition(unspent.begin(), unspent.end(),
-        [min_value](const output_info_type& out_info)
+    index_list indexes(values.size());
+    for (size_t i = 0; i < indexes.size(); ++i)
+        indexes[i] = i;
+    return indexes;
+}
+
+static uint64_t total_value(const value_list& values,
+    const index_list& selected)
+{
+    uint64_t total = 0;
+    for (size_t index: selected)
+        total += values[index];
+    return total;
+}
+
+/**
+ * Takes values in the given order until target is reached.
+ */
+static bool accumulate(const value_list& values, const index_list& order,
+    uint64_t target, index_list& selected)
+{
+    uint64_t accum = 0;
+    for (size_t index: order)
+    {
+        selected.push_back(index);
+        accum += values[index];
+        if (accum >= target)
+            return true;
+    }
+    selected.clear();
+    return false;
+}
+
+static bool select_greedy(const value_list& values, uint64_t target,
+    index_list& selected)
+{
+    index_list order = all_indexes(values);
+    auto lesser_begin = order.begin();
+    auto lesser_end = std::partition(order.begin(), order.end(),
+        [&values, target](size_t index)
         {
-            return out_info.value < min_value;
+            return values[index] < target;
         });
     auto greater_begin = lesser_end;
-    auto greater_end = unspent.end();
+    auto greater_end = order.end();
     auto min_greater = std::min_element(greater_begin, greater_end,
-        [](const output_info_type& info_a, const output_info_type& info_b)
+        [&values](size_t index_a, size_t index_b)
         {
-            return info_a.value < info_b.value;
+            return values[index_a] < values[index_b];
         });
-    select_outputs_result result;
     if (min_greater != greater_end)
     {
-        result.change = min_greater->value - min_value;
-        result.points.push_back(min_greater->point);
-        return result;
+        selected.push_back(*min_greater);
+        return true;
     }
     // Not found in greaters. Try several lessers instead.
     // Rearrange them from biggest to smallest. We want to use the least
     // amount of inputs as possible.
     std::sort(lesser_begin, lesser_end,
-        [](const output_info_type& info_a, const output_info_type& info_b)
+        [&values](size_t index_a, size_t index_b)
         {
-            return info_a.value > info_b.value;
+            return values[index_a] > values[index_b];
         });
-    uint64_t accum = 0;
-    for (auto it = lesser_begin; it != lesser_end; ++it)
+    order.erase(lesser_end, order.end());
+    return accumulate(values, order, target, selected);
+}
+
+static bool select_sorted(const value_list& values, uint64_t target,
+    bool largest_first, index_list& selected)
+{
+    index_list order = all_indexes(values);
+    std::sort(order.begin(), order.end(),
+        [&values, largest_first](size_t index_a, size_t index_b)
+        {
+            if (largest_first)
+                return values[index_a] > values[index_b];
+            return values[index_a] < values[index_b];
+        });
+    return accumulate(values, order, target, selected);
+}
+
+/**
+ * Depth-first search over include/omit decisions for each value, largest
+ * first, for a total within [target, target + tolerance]. The smallest
+ * excess found within max_iterations steps wins.
+ */
+static bool select_branch_and_bound(const value_list& values,
+    uint64_t target, uint64_t tolerance, size_t max_iterations,
+    index_list& selected)
+{
+    index_list order = all_indexes(values);
+    std::sort(order.begin(), order.end(),
+        [&values](size_t index_a, size_t index_b)
+        {
+            return values[index_a] > values[index_b];
+        });
+
+    uint64_t available = 0;
+    for (uint64_t value: values)
+        available += value;
+    if (available < target)
+        return false;
+
+    std::vector<bool> included;
+    std::vector<bool> best;
+    uint64_t current = 0;
+    uint64_t best_excess = std::numeric_limits<uint64_t>::max();
+    for (size_t step = 0; step < max_iterations; ++step)
+    {
+        bool backtrack = false;
+        // Written so that a huge tolerance cannot overflow.
+        if (current + available < target ||
+            (current > target && current - target > tolerance))
+            backtrack = true;
+        else if (current >= target)
+        {
+            if (current - target < best_excess)
+            {
+                best_excess = current - target;
+                best = included;
+                if (best_excess == 0)
+                    break;
+            }
+            backtrack = true;
+        }
+
+        if (backtrack)
+        {
+            // Undo trailing omissions, then omit the last included value.
+            while (!included.empty() && !included.back())
+            {
+                available += values[order[included.size() - 1]];
+                included.pop_back();
+            }
+            if (included.empty())
+                break;
+            included.back() = false;
+            current -= values[order[included.size() - 1]];
+            continue;
+        }
+
+        // The checks above guarantee there is a value left to decide on.
+        const uint64_t value = values[order[included.size()]];
+        available -= value;
+        // Including a value equal to one just omitted repeats a branch.
+        const bool repeat = !included.empty() && !included.back() &&
+            values[order[included.size() - 1]] == value;
+        included.push_back(!repeat);
+        if (!repeat)
+            current += value;
+    }
+
+    for (size_t i = 0; i < best.size(); ++i)
+        if (best[i])
+            selected.push_back(order[i]);
+    return !selected.empty();
+}
+
+/**
+ * Randomized search for the subset of values below target with the
+ * smallest total that still reaches it, compared against the smallest
+ * single value above target.
+ */
+static bool select_knapsack(const value_list& values, uint64_t target,
+    size_t max_iterations, index_list& selected)
+{
+    index_list lesser;
+    uint64_t lesser_total = 0;
+    size_t min_greater = values.size();
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        if (values[i] == target)
+        {
+            selected.push_back(i);
+            return true;
+        }
+        if (values[i] < target)
+        {
+            lesser.push_back(i);
+            lesser_total += values[i];
+        }
+        else if (min_greater == values.size() ||
+            values[i] < values[min_greater])
+            min_greater = i;
+    }
+
+    if (lesser_total == target)
     {
-        result.points.push_back(it->point);
-        accum += it->value;
-        if (accum >= min_value)
+        selected = lesser;
+        return true;
+    }
+    if (lesser_total < target)
+    {
+        if (min_greater == values.size())
+            return false;
+        selected.push_back(min_greater);
+        return true;
+    }
+
+    std::sort(lesser.begin(), lesser.end(),
+        [&values](size_t index_a, size_t index_b)
+        {
+            return values[index_a] > values[index_b];
+        });
+
+    // Seeded from the inputs so a given call always selects the same set.
+    std::mt19937_64 random(target ^ values.size());
+    std::bernoulli_distribution coin;
+    std::vector<bool> best(lesser.size(), true);
+    uint64_t best_total = lesser_total;
+    const size_t repetitions =
+        std::max<size_t>(max_iterations / lesser.size(), 1);
+    std::vector<bool> included(lesser.size());
+    for (size_t rep = 0; rep < repetitions && best_total != target; ++rep)
+    {
+        std::fill(included.begin(), included.end(), false);
+        uint64_t total = 0;
+        bool reached = false;
+        // First pass picks values at random, the second fills in the rest.
+        for (size_t pass = 0; pass < 2 && !reached; ++pass)
         {
-            result.change = accum - min_value;
-            return result;
+            for (size_t i = 0; i < lesser.size(); ++i)
+            {
+                if (included[i] || (pass == 0 && !coin(random)))
+                    continue;
+                total += values[lesser[i]];
+                included[i] = true;
+                if (total >= target)
+                {
+                    reached = true;
+                    if (total < best_total)
+                    {
+                        best_total = total;
+                        best = included;
+                    }
+                    // Try to do better without this one.
+                    total -= values[lesser[i]];
+                    included[i] = false;
+                }
+            }
         }
     }
-    return select_outputs_result();
+
+    if (min_greater != values.size() && best_total != target &&
+        values[min_greater] <= best_total)
+    {
+        selected.push_back(min_greater);
+        return true;
+    }
+    for (size_t i = 0; i < lesser.size(); ++i)
+        if (best[i])
+            selected.push_back(lesser[i]);
+    return true;
+}
+
+BCW_INTERNAL bool select_indexes(const value_list& values, uint64_t target,
+    uint64_t tolerance, select_outputs_algorithm alg, size_t max_iterations,
+    index_list& selected)
+{
+    switch (alg)
+    {
+        case select_outputs_algorithm::greedy:
+            return select_greedy(values, target, selected);
+        case select_outputs_algorithm::branch_and_bound:
+            return select_branch_and_bound(
+                values, target, tolerance, max_iterations, selected);
+        case select_outputs_algorithm::knapsack:
+            return select_knapsack(
+                values, target, max_iterations, selected);
+        case select_outputs_algorithm::largest_first:
+            return select_sorted(values, target, true, selected);
+        case select_outputs_algorithm::smallest_first:
+            return select_sorted(values, target, false, selected);
+    }
+    return false;
+}
+
+static uint64_t fee_for_size(const select_outputs_fee& fee, size_t size)
+{
+    // Round up so the rate is never undershot.
+    return (size * fee.fee_per_kb + 999) / 1000;
+}
+
+BCW_INTERNAL selection_costs get_costs(const select_outputs_fee& fee)
+{
+    selection_costs costs;
+    costs.input = fee_for_size(fee, fee.input_size);
+    costs.base = fee_for_size(fee,
+        fee.base_size + fee.output_count * fee.output_size);
+    costs.change = fee_for_size(fee, fee.output_size);
+    costs.min_change = costs.change + fee.dust_threshold;
+    return costs;
+}
+
+BCW_INTERNAL void set_change_and_fee(select_outputs_result& result,
+    const selection_costs& costs, uint64_t min_value,
+    uint64_t effective_total)
+{
+    const uint64_t inputs_fee = result.points.size() * costs.input;
+    const uint64_t excess = effective_total - min_value - costs.base;
+    if (excess >= costs.min_change)
+    {
+        result.change = excess - costs.change;
+        result.fee = costs.base + inputs_fee + costs.change;
+    }
+    else
+    {
+        result.change = 0;
+        result.fee = costs.base + inputs_fee + excess;
+    }
+}
+
+BCW_API select_outputs_result select_outputs(
+    const output_info_type* begin, const output_info_type* end,
+    uint64_t min_value, select_outputs_algorithm alg, size_t max_iterations)
+{
+    // Fail if empty.
+    if (begin == end)
+        return select_outputs_result();
+    value_list values;
+    values.reserve(end - begin);
+    for (auto it = begin; it != end; ++it)
+        values.push_back(it->value);
+
+    index_list selected;
+    if (!select_indexes(values, min_value, 0, alg, max_iterations, selected))
+        return select_outputs_result();
+    select_outputs_result result;
+    for (size_t index: selected)
+        result.points.push_back(begin[index].point);
+    result.change = total_value(values, selected) - min_value;
+    return result;
+}
+
+BCW_API select_outputs_result select_outputs(
+    const output_info_type* begin, const output_info_type* end,
+    uint64_t min_value, const select_outputs_fee& fee,
+    select_outputs_algorithm alg, size_t max_iterations)
+{
+    const selection_costs costs = get_costs(fee);
+
+    // Outputs that cost more to spend than they are worth are left out.
+    const size_t size = end - begin;
+    value_list values;
+    index_list positions;
+    values.reserve(size);
+    positions.reserve(size);
+    for (size_t i = 0; i < size; ++i)
+    {
+        if (begin[i].value <= costs.input)
+            continue;
+        values.push_back(begin[i].value - costs.input);
+        positions.push_back(i);
+    }
+    if (values.empty())
+        return select_outputs_result();
+
+    index_list selected;
+    if (!select_indexes(values, min_value + costs.base,
+        change_free_excess(costs), alg, max_iterations, selected))
+        return select_outputs_result();
+    select_outputs_result result;
+    for (size_t index: selected)
+        result.points.push_back(begin[positions[index]].point);
+    set_change_and_fee(result, costs, min_value,
+        total_value(values, selected));
+    return result;
+}
+
+BCW_API select_outputs_result select_outputs(
+    const output_info_list& unspent, uint64_t min_value,
+    select_outputs_algorithm alg, size_t max_iterations)
+{
+    return select_outputs(unspent.data(), unspent.data() + unspent.size(),
+        min_value, alg, max_iterations);
+}
+
+BCW_API select_outputs_result select_outputs(
+    const output_info_list& unspent, uint64_t min_value,
+    const select_outputs_fee& fee,
+    select_outputs_algorithm alg, size_t max_iterations)
+{
+    return select_outputs(unspent.data(), unspent.data() + unspent.size(),
+        min_value, fee, alg, max_iterations);
 }
 
 } // namespace libwallet
@@ -20,32 +20,68 @@
 #include <wallet/define.hpp>
 #include <wallet/uri.hpp>
 
-#include <boost/algorithm/string.hpp>
+#include <algorithm>
+#include <array>
+#include <iterator>
+#include <limits>
 #include <bitcoin/bitcoin.hpp>
 
 namespace libwallet {
 
-static bool is_digit(const char c)
+// Character classes, as bits in char_classes:
+constexpr uint8_t class_digit = 1 << 0;
+constexpr uint8_t class_hex = 1 << 1;
+constexpr uint8_t class_qchar = 1 << 2;
+constexpr uint8_t class_base58 = 1 << 3;
+constexpr uint8_t class_not_amp = 1 << 4;
+
+typedef std::array<uint8_t, 256> char_class_table;
+
+static char_class_table make_char_classes()
 {
-    return '0' <= c && c <= '9';
+    char_class_table table;
+    table.fill(0);
+    auto add = [&table](const char* chars, uint8_t bits)
+    {
+        for (; *chars; ++chars)
+            table[static_cast<uint8_t>(*chars)] |= bits;
+    };
+    const char* digits = "0123456789";
+    const char* upper = "ABCDEFGHIJKLMNOPQRSTUVWXYZ";
+    const char* lower = "abcdefghijklmnopqrstuvwxyz";
+    add(digits, class_digit | class_hex | class_qchar);
+    add("ABCDEFabcdef", class_hex);
+    add(upper, class_qchar);
+    add(lower, class_qchar);
+    add("-._~", class_qchar);           // unreserved
+    add("!$'()*+,;", class_qchar);      // sub-delims
+    add(":@", class_qchar);             // pchar
+    add("/?", class_qchar);             // query
+    add("123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz",
+        class_base58);
+    for (auto& entry: table)
+        entry |= class_not_amp;
+
+    // '%' is left out so escapes are still decoded in non-strict mode.
+    table[static_cast<uint8_t>('&')] &= ~class_not_amp;
+    table[static_cast<uint8_t>('%')] &= ~class_not_amp;
+    return table;
 }
-static bool is_hex(const char c)
+
+// One lookup per character instead of a chain of comparisons.
+static const char_class_table char_classes = make_char_classes();
+
+static bool has_class(const char c, uint8_t bits)
 {
-    return is_digit(c) || ('A' <= c && c <= 'F') || ('a' <= c && c <= 'f');
+    return (char_classes[static_cast<uint8_t>(c)] & bits) != 0;
 }
-static bool is_qchar(const char c)
-{
-    return
-        ('A' <= c && c <= 'Z') || ('a' <= c && c <= 'z') || is_digit(c) ||
-        '-' == c || '.' == c || '_' == c || '~' == c || // unreserved
-        '!' == c || '$' == c || '\'' == c || '(' == c || ')' == c ||
-        '*' == c || '+' == c || ',' == c || ';' == c || // sub-delims
-        ':' == c || '@' == c || // pchar
-        '/' == c || '?' == c;   // query
+static bool is_digit(const char c)
+{
+    return has_class(c, class_digit);
 }
-static bool isnt_amp(const char c)
+static bool is_hex(const char c)
 {
-    return '&' != c;
+    return has_class(c, class_hex);
 }
 
 static unsigned from_hex(const char c)
@@ -57,37 +93,54 @@ static unsigned from_hex(const char c)
     return c - '0';
 }
 
+static bool is_escape(const char* i, const char* end)
+{
+    return '%' == *i && 3 <= end - i && is_hex(i[1]) && is_hex(i[2]);
+}
+
 /**
- * Unescapes a percent-encoded string while advancing the iterator.
+ * Reads a possibly percent-encoded component while advancing the pointer.
  * @param i set to one-past the last-read character on return.
+ * @param buffer holds the unescaped component if it contains escapes.
+ * @return a view of the component, either in the input or in buffer.
  */
-typedef std::string::const_iterator sci;
-static std::string unescape(sci& i, sci end, bool (*is_valid)(const char))
+static boost::string_ref unescape(const char*& i, const char* end,
+    uint8_t valid_class, std::string& buffer)
 {
-    auto j = i;
-    size_t count = 0;
-    while (end != i && (is_valid(i[0]) ||
-        ('%' == *i && 2 < end - i && is_hex(i[1]) && is_hex(i[2]))))
+    const char* begin = i;
+    bool escaped = false;
+    while (end != i)
     {
-        ++count;
-        if ('%' == *i)
+        // Runs of plain characters are the common case:
+        while (end != i && has_class(*i, valid_class))
+            ++i;
+        if (end == i || '%' != *i)
+            break;
+        if (is_escape(i, end))
+        {
+            escaped = true;
             i += 3;
+        }
+        else if (valid_class == class_not_amp)
+            ++i; // Lenient parsing keeps a stray '%' as it is.
         else
-            ++i;
+            break;
     }
-    std::string out;
-    out.reserve(count);
-    while (j != i)
+    if (!escaped)
+        return boost::string_ref(begin, i - begin);
+
+    buffer.clear();
+    for (auto j = begin; j != i;)
     {
-        if ('%' == *j)
+        if (is_escape(j, i))
         {
-            out.push_back(from_hex(j[1]) << 4 | from_hex(j[2]));
+            buffer.push_back(from_hex(j[1]) << 4 | from_hex(j[2]));
             j += 3;
         }
         else
-            out.push_back(*j++);
+            buffer.push_back(*j++);
     }
-    return out;
+    return boost::string_ref(buffer);
 }
 
 /**
@@ -97,45 +150,49 @@ static std::string unescape(sci& i, sci end, bool (*is_valid)(const char))
  * false allows these malformed URI's to parse anyhow.
  * @return false if the URI is malformed.
  */
-BCW_API bool uri_parse(const std::string& uri, uri_visitor& result, 
+BCW_API bool uri_parse(boost::string_ref uri, uri_view_visitor& result,
     bool strict)
 {
-    auto i = uri.begin();
+    auto i = uri.data();
+    const auto end = uri.data() + uri.size();
 
     // URI scheme (this approach does not depend on the current locale):
     const char* lower = "bitcoin:";
     const char* upper = "BITCOIN:";
     while (*lower != '\0')
     {
-        if (uri.end() == i || (*lower != *i && *upper != *i))
+        if (end == i || (*lower != *i && *upper != *i))
             return false;
         ++lower; ++upper; ++i;
     }
 
+    // Only allocated if something is percent-encoded:
+    std::string key_buffer, value_buffer;
+
     // Payment address:
-    std::string address = unescape(i, uri.end(), libbitcoin::is_base58);
-    if (uri.end() != i && '?' != *i)
+    auto address = unescape(i, end, class_base58, value_buffer);
+    if (end != i && '?' != *i)
         return false;
     if (!address.empty() && !result.got_address(address))
         return false;
 
     // Parameters:
-    while (uri.end() != i)
+    while (end != i)
     {
         ++i; // Consume '?' or '&'
-        std::string key = unescape(i, uri.end(), is_qchar);
-        std::string value;
-        if (uri.end() != i && '=' == *i)
+        auto key = unescape(i, end, class_qchar, key_buffer);
+        boost::string_ref value;
+        if (end != i && '=' == *i)
         {
             ++i; // Consume '='
             if (key.empty())
                 return false;
             if (strict)
-                value = unescape(i, uri.end(), is_qchar);
+                value = unescape(i, end, class_qchar, value_buffer);
             else
-                value = unescape(i, uri.end(), isnt_amp);
+                value = unescape(i, end, class_not_amp, value_buffer);
         }
-        if (uri.end() != i && '&' != *i)
+        if (end != i && '&' != *i)
             return false;
         if (!key.empty() && !result.got_param(key, value))
             return false;
@@ -143,92 +200,298 @@ BCW_API bool uri_parse(const std::string& uri, uri_visitor& result,
     return true;
 }
 
+/**
+ * Copies views into strings for a uri_visitor.
+ */
+class uri_visitor_adapter
+  : public uri_view_visitor
+{
+public:
+    explicit uri_visitor_adapter(uri_visitor& visitor)
+      : visitor_(visitor)
+    {
+    }
+
+    bool got_address(boost::string_ref address)
+    {
+        std::string copy(address.begin(), address.end());
+        return visitor_.got_address(copy);
+    }
+
+    bool got_param(boost::string_ref key, boost::string_ref value)
+    {
+        std::string key_copy(key.begin(), key.end());
+        std::string value_copy(value.begin(), value.end());
+        return visitor_.got_param(key_copy, value_copy);
+    }
+
+private:
+    uri_visitor& visitor_;
+};
+
+BCW_API bool uri_parse(const std::string& uri, uri_visitor& result,
+    bool strict)
+{
+    uri_visitor_adapter adapter(result);
+    return uri_parse(boost::string_ref(uri), adapter, strict);
+}
+
+BCW_API uri_parse_result::uri_parse_result(address_cache* cache)
+  : cache_(cache)
+{
+}
+
+/**
+ * Decodes an address through cache if there is one.
+ */
+static bool set_encoded(libbitcoin::payment_address& address,
+    const std::string& encoded, address_cache* cache)
+{
+    if (cache)
+        return cache->set_encoded(address, encoded);
+    return decode_address(address, encoded);
+}
+
 BCW_API bool uri_parse_result::got_address(std::string& address)
 {
     libbitcoin::payment_address payaddr;
-    if (!payaddr.set_encoded(address))
+    if (!set_encoded(payaddr, address, cache_))
         return false;
     this->address.reset(payaddr);
     return true;
 }
 
-BCW_API bool uri_parse_result::got_param(std::string& key, std::string& value)
+static uint64_t parse_amount(const char* i, const char* end,
+    unsigned decmial_place);
+
+/**
+ * Stores the parameters uri_parse_result understands in the given fields,
+ * shared by uri_parse_result and uri_parse_batch.
+ * @return false for a bad amount or an unknown required parameter.
+ */
+static bool got_known_param(boost::string_ref key, boost::string_ref value,
+    uri_parse_result::optional_amount& amount,
+    uri_parse_result::optional_string& label,
+    uri_parse_result::optional_string& message,
+    uri_parse_result::optional_string& r)
 {
     if (key == "amount")
     {
-        uint64_t amount = parse_amount(value);
-        if (invalid_amount == amount)
+        const uint64_t parsed = parse_amount(value.data(),
+            value.data() + value.size(), 8);
+        if (invalid_amount == parsed)
             return false;
-        this->amount.reset(amount);
+        amount.reset(parsed);
     }
     else if (key == "label")
-        label.reset(value);
+        label.reset(value.to_string());
     else if (key == "message")
-        message.reset(value);
+        message.reset(value.to_string());
     else if (key == "r")
-        r.reset(value);
-    else if (!key.compare(0, 4, "req-"))
+        r.reset(value.to_string());
+    else if (key.starts_with("req-"))
         return false;
     return true;
 }
 
-BCW_API uint64_t parse_amount(const std::string& amount, 
-    unsigned decmial_place)
+BCW_API bool uri_parse_result::got_param(std::string& key, std::string& value)
 {
-    auto i = amount.begin();
-    uint64_t value = 0;
-    unsigned places = 0;
+    return got_known_param(key, value, amount, label, message, r);
+}
 
-    while (amount.end() != i && is_digit(*i))
+/**
+ * Converts 8 ASCII digits to their value with a few multiplies, by
+ * combining neighbouring digits, then pairs, then quads, in place.
+ */
+static uint64_t parse_eight_digits(const char* digits)
+{
+    // Assembled byte by byte so the first digit is lowest on any host.
+    uint64_t chunk = 0;
+    for (size_t i = 8; i-- > 0;)
+        chunk = chunk << 8 | static_cast<uint8_t>(digits[i]);
+    chunk -= 0x3030303030303030;
+    chunk = (chunk * 10 + (chunk >> 8)) & 0x00ff00ff00ff00ff;
+    chunk = (chunk * 100 + (chunk >> 16)) & 0x0000ffff0000ffff;
+    return (chunk * 10000 + (chunk >> 32)) & 0xffffffff;
+}
+
+/**
+ * Appends decimal digits to value, returning false on overflow.
+ * The digits must already be validated.
+ */
+static bool append_digits(uint64_t& value, const char* i, const char* end)
+{
+    constexpr uint64_t max = std::numeric_limits<uint64_t>::max();
+    for (; end - i >= 8; i += 8)
     {
-        value = 10*value + (*i - '0');
-        ++i;
+        const uint64_t chunk = parse_eight_digits(i);
+        if (value > (max - chunk) / 100000000)
+            return false;
+        value = value * 100000000 + chunk;
     }
-    if (amount.end() != i && '.' == *i)
+    for (; end != i; ++i)
     {
+        const uint64_t digit = *i - '0';
+        if (value > (max - digit) / 10)
+            return false;
+        value = value * 10 + digit;
+    }
+    return true;
+}
+
+static uint64_t parse_amount(const char* i, const char* end,
+    unsigned decmial_place)
+{
+    constexpr uint64_t max = std::numeric_limits<uint64_t>::max();
+
+    // Find the whole and fractional digits:
+    const char* whole = i;
+    while (end != i && is_digit(*i))
         ++i;
-        while (amount.end() != i && is_digit(*i))
-        {
-            if (places < decmial_place)
-                value = 10*value + (*i - '0');
-            else if (places == decmial_place && '5' <= *i)
-                value += 1;
-            ++places;
+    const char* whole_end = i;
+    const char* fraction = i;
+    if (end != i && '.' == *i)
+    {
+        fraction = ++i;
+        while (end != i && is_digit(*i))
             ++i;
-        }
     }
-    while (places < decmial_place)
+    const char* fraction_end = i;
+    if (end != i)
+        return invalid_amount;
+
+    // Shift the decimal point right by decmial_place:
+    const size_t places = std::min<size_t>(
+        fraction_end - fraction, decmial_place);
+    uint64_t value = 0;
+    if (!append_digits(value, whole, whole_end) ||
+        !append_digits(value, fraction, fraction + places))
+        return invalid_amount;
+    for (size_t pad = places; pad < decmial_place; ++pad)
     {
+        if (value > max / 10)
+            return invalid_amount;
         value *= 10;
-        ++places;
     }
-    if (amount.end() != i)
-        return invalid_amount;
-    return value;
+
+    // Round half up on the first dropped digit:
+    if (fraction + places != fraction_end && '5' <= fraction[places])
+        ++value;
+
+    // Anything reaching the sentinel itself is out of range too.
+    return value == max ? invalid_amount : value;
+}
+
+BCW_API uint64_t parse_amount(const std::string& amount,
+    unsigned decmial_place)
+{
+    return parse_amount(amount.data(), amount.data() + amount.size(),
+        decmial_place);
+}
+
+BCW_API std::vector<uint64_t> parse_amounts(
+    const std::vector<std::string>& amounts, unsigned decmial_place)
+{
+    std::vector<uint64_t> result;
+    result.reserve(amounts.size());
+    for (const std::string& amount: amounts)
+        result.push_back(parse_amount(amount.data(),
+            amount.data() + amount.size(), decmial_place));
+    return result;
 }
 
 /**
- * Percent-encodes a string.
- * @param is_valid a function returning true for acceptable characters.
+ * Fills one row of a uri_batch_result, accepting the same parameters
+ * as uri_parse_result.
  */
-static std::string escape(const std::string& in, bool (*is_valid)(char))
+class uri_batch_visitor
+  : public uri_view_visitor
 {
-    std::ostringstream stream;
-    stream << std::hex << std::uppercase << std::setfill('0');
+public:
+    uri_batch_visitor(uri_batch_result& result, size_t row,
+        address_cache* cache)
+      : result_(result), row_(row), cache_(cache)
+    {
+    }
+
+    bool got_address(boost::string_ref address)
+    {
+        libbitcoin::payment_address payaddr;
+        if (!set_encoded(payaddr, address.to_string(), cache_))
+            return false;
+        result_.address[row_].reset(payaddr);
+        return true;
+    }
+
+    bool got_param(boost::string_ref key, boost::string_ref value)
+    {
+        return got_known_param(key, value, result_.amount[row_],
+            result_.label[row_], result_.message[row_], result_.r[row_]);
+    }
+
+private:
+    uri_batch_result& result_;
+    size_t row_;
+    address_cache* cache_;
+};
+
+BCW_API uri_batch_result uri_parse_batch(const std::vector<std::string>& uris,
+    bool strict, address_cache* cache)
+{
+    uri_batch_result result;
+    const size_t rows = uris.size();
+    result.valid.resize(rows, false);
+    result.address.resize(rows);
+    result.amount.resize(rows);
+    result.label.resize(rows);
+    result.message.resize(rows);
+    result.r.resize(rows);
+    for (size_t row = 0; row < rows; ++row)
+    {
+        uri_batch_visitor visitor(result, row, cache);
+        result.valid[row] =
+            uri_parse(boost::string_ref(uris[row]), visitor, strict);
+        if (result.valid[row])
+            continue;
+
+        // Drop whatever was read before the error.
+        result.address[row].reset();
+        result.amount[row].reset();
+        result.label[row].reset();
+        result.message[row].reset();
+        result.r[row].reset();
+    }
+    return result;
+}
+
+/**
+ * Appends a percent-encoded string.
+ * @param valid_class the characters which need no escaping.
+ */
+static void escape(std::string& out, const std::string& in,
+    uint8_t valid_class)
+{
+    const char* hex = "0123456789ABCDEF";
     for (auto c: in)
     {
-        if (is_valid(c))
-            stream << c;
+        if (has_class(c, valid_class))
+            out.push_back(c);
         else
-            stream << '%' << std::setw(2) << +c;
+        {
+            const auto byte = static_cast<uint8_t>(c);
+            out.push_back('%');
+            out.push_back(hex[byte >> 4]);
+            out.push_back(hex[byte & 0xf]);
+        }
     }
-    return stream.str();
 }
 
 BCW_API uri_writer::uri_writer()
   : first_param_{true}
 {
-    stream_ << "bitcoin:";
+    // Enough for an address, an amount and a short label:
+    buffer_.reserve(128);
+    buffer_ += "bitcoin:";
 }
 
 BCW_API void uri_writer::write_address(
@@ -239,16 +502,33 @@ BCW_API void uri_writer::write_address(
 
 BCW_API void uri_writer::write_amount(uint64_t satoshis)
 {
-    // Format as a fixed-point number:
+    // Format as a fixed-point number, least significant digit first:
+    char digits[32];
+    size_t size = 0;
+    uint64_t fraction = satoshis % libbitcoin::coin_price();
     uint64_t bitcoin = satoshis / libbitcoin::coin_price();
-    satoshis = satoshis % libbitcoin::coin_price();
-    std::ostringstream stream;
-    stream << bitcoin << '.' << std::setw(8) << std::setfill('0') << satoshis;
-    // Trim trailing zeros:
-    auto string = stream.str();
-    boost::algorithm::trim_right_if(string, [](char c){ return '0' == c; });
-    boost::algorithm::trim_right_if(string, [](char c){ return '.' == c; });
-    write_param("amount", string);
+    if (fraction)
+    {
+        // Trim trailing zeros:
+        unsigned places = 8;
+        while (fraction % 10 == 0)
+        {
+            fraction /= 10;
+            --places;
+        }
+        for (; places > 0; --places, fraction /= 10)
+            digits[size++] = '0' + fraction % 10;
+        digits[size++] = '.';
+    }
+    do
+    {
+        digits[size++] = '0' + bitcoin % 10;
+        bitcoin /= 10;
+    } while (bitcoin);
+
+    start_param("amount");
+    buffer_.append(std::reverse_iterator<const char*>(digits + size),
+        std::reverse_iterator<const char*>(digits));
 }
 
 BCW_API void uri_writer::write_label(const std::string& label)
@@ -268,23 +548,30 @@ BCW_API void uri_writer::write_r(const std::string& r)
 
 BCW_API void uri_writer::write_address(const std::string& address)
 {
-    stream_ << address;
+    buffer_ += address;
 }
 
-BCW_API void uri_writer::write_param(const std::string& key, 
-    const std::string& value)
+void uri_writer::start_param(const std::string& key)
 {
-    if (first_param_)
-        stream_ << '?';
-    else
-        stream_ << '&';
+    buffer_.push_back(first_param_ ? '?' : '&');
     first_param_ = false;
-    stream_ << escape(key, is_qchar) << '=' << escape(value, is_qchar);
+    escape(buffer_, key, class_qchar);
+    buffer_.push_back('=');
+}
+
+BCW_API void uri_writer::write_param(const std::string& key,
+    const std::string& value)
+{
+    // Room for the worst case, every character escaped:
+    buffer_.reserve(buffer_.size() + 2 + 3 * (key.size() + value.size()));
+    start_param(key);
+    escape(buffer_, value, class_qchar);
 }
 
 BCW_API std::string uri_writer::string() const
 {
-    return stream_.str();
+    return buffer_;
 }
 
 } // namespace libwallet
+
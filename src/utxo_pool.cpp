@@ -0,0 +1,331 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <wallet/define.hpp>
+#include <wallet/utxo_pool.hpp>
+
+#include <algorithm>
+#include <iterator>
+#include <limits>
+#include <bitcoin/bitcoin.hpp>
+#include "select_outputs.hpp"
+
+namespace libwallet {
+
+bool utxo_pool::point_less::operator()(
+    const output_point& a, const output_point& b) const
+{
+    if (a.index != b.index)
+        return a.index < b.index;
+    return a.hash < b.hash;
+}
+
+BCW_API utxo_pool::utxo_pool()
+  : total_value_(0)
+{
+}
+
+BCW_API utxo_pool::utxo_pool(const output_info_list& unspent)
+  : total_value_(0)
+{
+    for (const output_info_type& output: unspent)
+        insert(output);
+}
+
+BCW_API utxo_pool::utxo_pool(const utxo_pool& other)
+  : total_value_(0)
+{
+    // by_point_ holds iterators into by_value_, so rebuild rather than
+    // copy the maps.
+    for (const auto& entry: other.by_value_)
+        insert(output_info_type{entry.second, entry.first});
+}
+
+BCW_API utxo_pool& utxo_pool::operator=(const utxo_pool& other)
+{
+    if (this == &other)
+        return *this;
+    by_point_.clear();
+    by_value_.clear();
+    total_value_ = 0;
+    for (const auto& entry: other.by_value_)
+        insert(output_info_type{entry.second, entry.first});
+    return *this;
+}
+
+BCW_API bool utxo_pool::insert(const output_info_type& output)
+{
+    if (by_point_.count(output.point))
+        return false;
+    auto it = by_value_.emplace(output.value, output.point);
+    by_point_.emplace(output.point, it);
+    total_value_ += output.value;
+    return true;
+}
+
+BCW_API bool utxo_pool::remove(const output_point& point)
+{
+    auto it = by_point_.find(point);
+    if (it == by_point_.end())
+        return false;
+    total_value_ -= it->second->first;
+    by_value_.erase(it->second);
+    by_point_.erase(it);
+    return true;
+}
+
+BCW_API void utxo_pool::spend(const select_outputs_result& selection)
+{
+    for (const output_point& point: selection.points)
+        remove(point);
+}
+
+BCW_API output_info_list utxo_pool::take(const output_point_list& points)
+{
+    output_info_list result;
+    result.reserve(points.size());
+    for (const output_point& point: points)
+    {
+        auto it = by_point_.find(point);
+        if (it == by_point_.end())
+            continue;
+        result.push_back(output_info_type{point, it->second->first});
+        total_value_ -= it->second->first;
+        by_value_.erase(it->second);
+        by_point_.erase(it);
+    }
+    return result;
+}
+
+BCW_API bool utxo_pool::contains(const output_point& point) const
+{
+    return by_point_.count(point) != 0;
+}
+
+BCW_API size_t utxo_pool::size() const
+{
+    return by_value_.size();
+}
+
+BCW_API bool utxo_pool::empty() const
+{
+    return by_value_.empty();
+}
+
+BCW_API uint64_t utxo_pool::total_value() const
+{
+    return total_value_;
+}
+
+BCW_API output_info_list utxo_pool::outputs() const
+{
+    output_info_list result;
+    result.reserve(by_value_.size());
+    for (const auto& entry: by_value_)
+        result.push_back(output_info_type{entry.second, entry.first});
+    return result;
+}
+
+/**
+ * Adds outputs in iteration order until target is reached, counting each
+ * at its value less input_cost. Stops at the first output not worth more
+ * than input_cost, so the range must be ordered to put those last.
+ */
+template <typename Iterator>
+static bool accumulate(Iterator begin, Iterator end, uint64_t target,
+    uint64_t input_cost, select_outputs_result& result,
+    uint64_t& effective_total)
+{
+    effective_total = 0;
+    for (auto it = begin; it != end && it->first > input_cost; ++it)
+    {
+        result.points.push_back(it->second);
+        effective_total += it->first - input_cost;
+        if (effective_total >= target)
+            return true;
+    }
+    result.points.clear();
+    return false;
+}
+
+bool utxo_pool::select_effective(uint64_t target, uint64_t input_cost,
+    uint64_t tolerance, select_outputs_algorithm alg, size_t max_iterations,
+    select_outputs_result& result, uint64_t& effective_total) const
+{
+    // Outputs worth more than an input costs, smallest first.
+    const auto usable = by_value_.upper_bound(input_cost);
+    if (usable == by_value_.end())
+        return false;
+
+    switch (alg)
+    {
+        case select_outputs_algorithm::greedy:
+        {
+            // Smallest single output covering the value, otherwise
+            // everything below it, biggest first.
+            if (target <= std::numeric_limits<uint64_t>::max() - input_cost)
+            {
+                auto min_greater = by_value_.lower_bound(target + input_cost);
+                if (min_greater != by_value_.end())
+                    return accumulate(min_greater, std::next(min_greater),
+                        target, input_cost, result, effective_total);
+            }
+            return accumulate(by_value_.rbegin(), by_value_.rend(),
+                target, input_cost, result, effective_total);
+        }
+        case select_outputs_algorithm::largest_first:
+            return accumulate(by_value_.rbegin(), by_value_.rend(),
+                target, input_cost, result, effective_total);
+        case select_outputs_algorithm::smallest_first:
+            return accumulate(usable, by_value_.end(),
+                target, input_cost, result, effective_total);
+        default:
+            break;
+    }
+
+    // The searching algorithms need every value anyway.
+    value_list values;
+    std::vector<value_map::const_iterator> entries;
+    const size_t count = std::distance(usable, by_value_.end());
+    values.reserve(count);
+    entries.reserve(count);
+    for (auto it = usable; it != by_value_.end(); ++it)
+    {
+        values.push_back(it->first - input_cost);
+        entries.push_back(it);
+    }
+    index_list selected;
+    if (!select_indexes(values, target, tolerance, alg, max_iterations,
+        selected))
+        return false;
+    effective_total = 0;
+    for (size_t index: selected)
+    {
+        result.points.push_back(entries[index]->second);
+        effective_total += values[index];
+    }
+    return true;
+}
+
+BCW_API select_outputs_result utxo_pool::select(uint64_t min_value,
+    select_outputs_algorithm alg, size_t max_iterations) const
+{
+    if (total_value_ < min_value)
+        return select_outputs_result();
+    select_outputs_result result;
+    uint64_t accum = 0;
+    if (!select_effective(min_value, 0, 0, alg, max_iterations,
+        result, accum))
+        return select_outputs_result();
+    result.change = accum - min_value;
+    return result;
+}
+
+BCW_API select_outputs_result utxo_pool::select(uint64_t min_value,
+    const select_outputs_fee& fee, select_outputs_algorithm alg,
+    size_t max_iterations) const
+{
+    const selection_costs costs = get_costs(fee);
+    if (total_value_ < min_value + costs.base)
+        return select_outputs_result();
+    select_outputs_result result;
+    uint64_t effective_total = 0;
+    if (!select_effective(min_value + costs.base, costs.input,
+        change_free_excess(costs), alg, max_iterations, result,
+        effective_total))
+        return select_outputs_result();
+    set_change_and_fee(result, costs, min_value, effective_total);
+    return result;
+}
+
+/**
+ * Serialized size of a transaction paying output_count outputs from
+ * selection, counting a change output if there is change.
+ */
+static size_t transaction_size(const select_outputs_fee& fee,
+    size_t output_count, const select_outputs_result& selection)
+{
+    const size_t outputs = output_count + (selection.change ? 1 : 0);
+    return fee.base_size + outputs * fee.output_size +
+        selection.points.size() * fee.input_size;
+}
+
+BCW_API batch_transaction_list utxo_pool::select_batch(
+    const std::vector<uint64_t>& amounts, const select_outputs_fee& fee,
+    size_t max_size, select_outputs_algorithm alg, size_t max_iterations)
+{
+    batch_transaction_list result;
+    output_info_list taken;
+    bool funded = true;
+    size_t next = 0;
+    while (next < amounts.size())
+    {
+        // Start from the most payments that could fit with one input and
+        // change, and give back the last payment until the inputs fit too.
+        size_t count = amounts.size() - next;
+        if (max_size)
+        {
+            const size_t fixed =
+                fee.base_size + fee.input_size + fee.output_size;
+            if (max_size <= fixed)
+                count = 0;
+            else if (fee.output_size)
+                count = std::min(count, (max_size - fixed) / fee.output_size);
+        }
+        batch_transaction transaction;
+        for (; count > 0; --count)
+        {
+            select_outputs_fee group_fee = fee;
+            group_fee.output_count = count;
+            uint64_t value = 0;
+            for (size_t i = next; i < next + count; ++i)
+                value += amounts[i];
+            transaction.selection = select(value, group_fee, alg,
+                max_iterations);
+            // Without a size limit everything goes in one transaction.
+            if (!max_size)
+                break;
+            if (!transaction.selection.points.empty() && transaction_size(
+                fee, count, transaction.selection) <= max_size)
+                break;
+        }
+        if (count == 0 || transaction.selection.points.empty())
+        {
+            funded = false;
+            break;
+        }
+        for (size_t i = next; i < next + count; ++i)
+            transaction.payments.push_back(i);
+        next += count;
+
+        // Later transactions must not reuse these inputs.
+        const output_info_list spent = take(transaction.selection.points);
+        taken.insert(taken.end(), spent.begin(), spent.end());
+        result.push_back(std::move(transaction));
+    }
+
+    for (const output_info_type& output: taken)
+        insert(output);
+    if (!funded)
+        return batch_transaction_list();
+    return result;
+}
+
+} // namespace libwallet
+
@@ -0,0 +1,173 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <wallet/define.hpp>
+#include <wallet/utxo_selector.hpp>
+
+#include <bitcoin/bitcoin.hpp>
+
+namespace libwallet {
+
+typedef std::lock_guard<std::mutex> selector_lock;
+
+// Searches outside the lock before searching under it.
+constexpr size_t reserve_attempts = 3;
+
+BCW_API utxo_selector::utxo_selector()
+  : last_id_(0)
+{
+}
+
+BCW_API utxo_selector::utxo_selector(const output_info_list& unspent)
+  : available_(unspent), last_id_(0)
+{
+}
+
+BCW_API bool utxo_selector::insert(const output_info_type& output)
+{
+    selector_lock lock(mutex_);
+    if (reserved_.contains(output.point))
+        return false;
+    return available_.insert(output);
+}
+
+BCW_API bool utxo_selector::remove(const output_point& point)
+{
+    selector_lock lock(mutex_);
+    return available_.remove(point);
+}
+
+// Caller must hold mutex_.
+utxo_reservation utxo_selector::hold(const select_outputs_result& selection)
+{
+    utxo_reservation reservation;
+    if (selection.points.empty())
+        return reservation;
+    for (const output_info_type& output: available_.take(selection.points))
+        reserved_.insert(output);
+    reservation.id = ++last_id_;
+    reservation.selection = selection;
+    reservations_.emplace(reservation.id, selection.points);
+    return reservation;
+}
+
+// Caller must hold mutex_.
+bool utxo_selector::available(const output_point_list& points) const
+{
+    for (const output_point& point: points)
+        if (!available_.contains(point))
+            return false;
+    return true;
+}
+
+utxo_reservation utxo_selector::reserve_selected(
+    select_outputs_algorithm alg, const selection_function& select)
+{
+    // The searching algorithms may run for max_iterations, so they work
+    // on a copy and only lock to take a flat list of the outputs and to
+    // claim the result. The copy's maps are built without the lock.
+    const bool search = alg == select_outputs_algorithm::branch_and_bound ||
+        alg == select_outputs_algorithm::knapsack;
+    for (size_t attempt = 0; search && attempt < reserve_attempts; ++attempt)
+    {
+        output_info_list outputs;
+        {
+            selector_lock lock(mutex_);
+            outputs = available_.outputs();
+        }
+        const utxo_pool snapshot(outputs);
+        const select_outputs_result selection = select(snapshot);
+        selector_lock lock(mutex_);
+        if (available(selection.points))
+            return hold(selection);
+    }
+
+    // Too much contention, or an algorithm cheaper than the copy.
+    selector_lock lock(mutex_);
+    return hold(select(available_));
+}
+
+BCW_API utxo_reservation utxo_selector::reserve(uint64_t min_value,
+    select_outputs_algorithm alg, size_t max_iterations)
+{
+    return reserve_selected(alg, [&](const utxo_pool& pool)
+    {
+        return pool.select(min_value, alg, max_iterations);
+    });
+}
+
+BCW_API utxo_reservation utxo_selector::reserve(uint64_t min_value,
+    const select_outputs_fee& fee, select_outputs_algorithm alg,
+    size_t max_iterations)
+{
+    return reserve_selected(alg, [&](const utxo_pool& pool)
+    {
+        return pool.select(min_value, fee, alg, max_iterations);
+    });
+}
+
+BCW_API bool utxo_selector::commit(uint64_t id)
+{
+    selector_lock lock(mutex_);
+    auto it = reservations_.find(id);
+    if (it == reservations_.end())
+        return false;
+    reserved_.take(it->second);
+    reservations_.erase(it);
+    return true;
+}
+
+BCW_API bool utxo_selector::release(uint64_t id)
+{
+    selector_lock lock(mutex_);
+    auto it = reservations_.find(id);
+    if (it == reservations_.end())
+        return false;
+    for (const output_info_type& output: reserved_.take(it->second))
+        available_.insert(output);
+    reservations_.erase(it);
+    return true;
+}
+
+BCW_API size_t utxo_selector::available_size() const
+{
+    selector_lock lock(mutex_);
+    return available_.size();
+}
+
+BCW_API uint64_t utxo_selector::available_value() const
+{
+    selector_lock lock(mutex_);
+    return available_.total_value();
+}
+
+BCW_API size_t utxo_selector::reserved_size() const
+{
+    selector_lock lock(mutex_);
+    return reserved_.size();
+}
+
+BCW_API uint64_t utxo_selector::reserved_value() const
+{
+    selector_lock lock(mutex_);
+    return reserved_.total_value();
+}
+
+} // namespace libwallet
+
@@ -0,0 +1,309 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <wallet/define.hpp>
+#include <wallet/vanity.hpp>
+
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <limits>
+#include <mutex>
+#include <bitcoin/bitcoin.hpp>
+#include <wallet/random.hpp>
+#include <wallet/stealth.hpp>
+#include "parallel.hpp"
+#include "sha256.hpp"
+#include "sha512.hpp"
+
+namespace libwallet {
+
+static const char* base58_alphabet =
+    "123456789ABCDEFGHJKLMNPQRSTUVWXYZabcdefghijkmnopqrstuvwxyz";
+
+// Children or ephemeral keys claimed by a worker at a time.
+constexpr size_t vanity_batch_size = 256;
+
+// Stealth attempts between checks of max_attempts.
+constexpr uint64_t vanity_round_size = 1 << 20;
+
+/**
+ * number = number * factor + addend, returning false on overflow.
+ */
+template <typename Number>
+static bool multiply_add(Number& number, uint32_t factor, uint32_t addend)
+{
+    uint64_t carry = addend;
+    for (size_t i = number.size(); i-- > 0;)
+    {
+        carry += static_cast<uint64_t>(number[i]) * factor;
+        number[i] = static_cast<uint32_t>(carry);
+        carry >>= 32;
+    }
+    return carry == 0;
+}
+
+/**
+ * 256 to the power of bytes.
+ */
+template <typename Number>
+static Number power_of_256(size_t bytes)
+{
+    Number number;
+    number.fill(0);
+    const size_t bit = 8 * bytes;
+    number[number.size() - 1 - bit / 32] = uint32_t(1) << (bit % 32);
+    return number;
+}
+
+BCW_API base58_prefix::base58_prefix(const std::string& prefix)
+  : text_(prefix), valid_(false), zeros_(0)
+{
+    // Each leading '1' stands for a leading zero byte.
+    while (zeros_ < prefix.size() && prefix[zeros_] == '1')
+        ++zeros_;
+    if (zeros_ == prefix.size())
+    {
+        valid_ = zeros_ <= address_payload_size;
+        return;
+    }
+    if (zeros_ >= address_payload_size)
+        return;
+
+    // The rest are the leading digits of the payload as a number.
+    number value;
+    value.fill(0);
+    for (size_t i = zeros_; i < prefix.size(); ++i)
+    {
+        const char* digit = std::strchr(base58_alphabet, prefix[i]);
+        if (prefix[i] == '\0' || !digit)
+            return;
+        const auto digit_value =
+            static_cast<uint32_t>(digit - base58_alphabet);
+        if (!multiply_add(value, 58, digit_value))
+            return;
+    }
+
+    // Numbers with exactly zeros_ leading zero bytes.
+    const size_t bytes = address_payload_size - zeros_;
+    const number floor = power_of_256<number>(bytes - 1);
+    const number ceiling = power_of_256<number>(bytes);
+
+    // An encoding n digits longer than the prefix starts with it if the
+    // number is in [value * 58^n, (value + 1) * 58^n).
+    range candidate{value, value};
+    multiply_add(candidate.high, 1, 1);
+    while (candidate.low < ceiling)
+    {
+        const range clipped
+        {
+            std::max(candidate.low, floor),
+            std::min(candidate.high, ceiling)
+        };
+        if (clipped.low < clipped.high)
+            ranges_.push_back(clipped);
+        if (!multiply_add(candidate.low, 58, 0) ||
+            !multiply_add(candidate.high, 58, 0))
+            break;
+    }
+    valid_ = !ranges_.empty();
+}
+
+BCW_API bool base58_prefix::valid() const
+{
+    return valid_;
+}
+
+BCW_API const std::string& base58_prefix::text() const
+{
+    return text_;
+}
+
+BCW_API bool base58_prefix::matches(const uint8_t* payload) const
+{
+    if (!valid_)
+        return false;
+    size_t zeros = 0;
+    while (zeros < address_payload_size && payload[zeros] == 0)
+        ++zeros;
+    if (ranges_.empty())
+        return zeros >= zeros_;
+    if (zeros != zeros_)
+        return false;
+
+    number value;
+    value.fill(0);
+    const size_t offset = 4 * value.size() - address_payload_size;
+    for (size_t i = 0; i < address_payload_size; ++i)
+    {
+        const size_t position = offset + i;
+        value[position / 4] |=
+            uint32_t(payload[i]) << (8 * (3 - position % 4));
+    }
+    for (const range& candidate: ranges_)
+        if (!(value < candidate.low) && value < candidate.high)
+            return true;
+    return false;
+}
+
+BCW_API bool base58_prefix::matches(uint8_t version,
+    const short_hash& hash) const
+{
+    uint8_t payload[address_payload_size];
+    payload[0] = version;
+    std::copy(hash.begin(), hash.end(), payload + 1);
+    const hash_digest checksum = double_sha256(payload, 1 + hash.size());
+    std::copy(checksum.begin(), checksum.begin() + 4,
+        payload + 1 + hash.size());
+    return matches(payload);
+}
+
+BCW_API bool base58_prefix::reachable(uint8_t version) const
+{
+    if (!valid_)
+        return false;
+
+    // Only a zero version byte gives leading '1's.
+    if (ranges_.empty())
+        return version == 0 || zeros_ == 0;
+
+    // Payloads starting with the version byte, as numbers. The ranges
+    // already require exactly zeros_ leading zero bytes.
+    const size_t offset = 4 * number().size() - address_payload_size;
+    number low;
+    low.fill(0);
+    low[offset / 4] = uint32_t(version) << (8 * (3 - offset % 4));
+    number high = low;
+    high[offset / 4] += uint32_t(1) << (8 * (3 - offset % 4));
+    for (const range& candidate: ranges_)
+        if (candidate.low < high && low < candidate.high)
+            return true;
+    return false;
+}
+
+BCW_API std::vector<uint32_t> find_vanity_children(
+    const hd_public_key& key, const base58_prefix& prefix,
+    uint32_t first_index, uint32_t count, size_t max_results,
+    size_t threads)
+{
+    std::vector<uint32_t> result;
+    if (!key.valid() || max_results == 0 ||
+        !prefix.reachable(payment_address::pubkey_version) ||
+        first_index >= first_hardened_key)
+        return result;
+    count = std::min(count, first_hardened_key - first_index);
+
+    // Every child hashes under the same chain code, so absorb it once.
+    const chain_code_type& chain_code = key.chain_code();
+    const hmac_sha512_key hmac(chain_code.data(), chain_code.size());
+    const ec_point& parent = key.public_key();
+    if (parent.size() != ec_compressed_size)
+        return result;
+
+    // Indexes past the lowest max_results matches found so far are not
+    // worth trying. Batches are claimed in order, so every index below
+    // the cutoff still gets tried.
+    std::atomic<uint64_t> cutoff(std::numeric_limits<uint64_t>::max());
+    std::mutex mutex;
+    parallel_for(count, threads, vanity_batch_size,
+        [&](size_t begin, size_t end)
+        {
+            uint8_t data[ec_compressed_size + 4];
+            std::copy(parent.begin(), parent.end(), data);
+            std::vector<uint32_t> found;
+            for (size_t i = begin; i < end; ++i)
+            {
+                const uint32_t index =
+                    static_cast<uint32_t>(first_index + i);
+                if (index > cutoff)
+                    break;
+                const auto index_bytes = to_big_endian(index);
+                std::copy(index_bytes.begin(), index_bytes.end(),
+                    data + ec_compressed_size);
+                const long_hash I = hmac.hash(data, sizeof(data));
+
+                // The child key is point(parse256(IL)) + Kpar.
+                ec_secret IL;
+                std::copy(I.begin(), I.begin() + IL.size(), IL.begin());
+                ec_point child = parent;
+                if (!ec_tweak_add(child, IL))
+                    continue;
+                if (prefix.matches(payment_address::pubkey_version,
+                    bitcoin_short_hash(child)))
+                    found.push_back(index);
+            }
+            if (found.empty())
+                return;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            result.insert(result.end(), found.begin(), found.end());
+            if (result.size() >= max_results)
+            {
+                std::nth_element(result.begin(),
+                    result.begin() + max_results - 1, result.end());
+                cutoff = result[max_results - 1];
+            }
+        });
+
+    std::sort(result.begin(), result.end());
+    if (result.size() > max_results)
+        result.resize(max_results);
+    return result;
+}
+
+BCW_API bool find_vanity_stealth(const ec_point& scan_pubkey,
+    const ec_point& spend_pubkey, const base58_prefix& prefix,
+    ec_secret& ephem_secret, uint64_t max_attempts, size_t threads)
+{
+    if (!prefix.reachable(payment_address::pubkey_version))
+        return false;
+
+    std::atomic<bool> found(false);
+    std::mutex mutex;
+    for (uint64_t tried = 0;
+        !found && (max_attempts == 0 || tried < max_attempts);)
+    {
+        uint64_t round = vanity_round_size;
+        if (max_attempts)
+            round = std::min(round, max_attempts - tried);
+        parallel_for(static_cast<size_t>(round), threads, vanity_batch_size,
+            [&](size_t begin, size_t end)
+            {
+                for (size_t i = begin; i < end && !found; ++i)
+                {
+                    const ec_secret secret = new_secret();
+                    const ec_point payment =
+                        initiate_stealth(secret, scan_pubkey, spend_pubkey);
+                    if (!prefix.matches(payment_address::pubkey_version,
+                        bitcoin_short_hash(payment)))
+                        continue;
+
+                    std::lock_guard<std::mutex> lock(mutex);
+                    if (!found)
+                        ephem_secret = secret;
+                    found = true;
+                }
+            });
+        tried += round;
+    }
+    return found;
+}
+
+} // namespace libwallet
+
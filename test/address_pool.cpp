@@ -0,0 +1,103 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <mutex>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <wallet/wallet.hpp>
+
+using namespace libwallet;
+
+static hd_public_key test_account()
+{
+    hd_public_key account;
+    account.set_serialized(
+        "xpub6FnCn6nSzZAw5Tw7cgR9bi15UV96gLZhjDstkXXxvCLsUXBGXPdS"
+        "nLFbdpq8p9HmGsApME5hQTZ3emM2rnY5agb9rXpVGyy3bdW6EEgAtqt");
+    return account;
+}
+
+BOOST_AUTO_TEST_CASE(address_pool_test)
+{
+    const hd_public_key account = test_account();
+    BOOST_REQUIRE(account.valid());
+
+    address_pool pool(account, 3, 8);
+    BOOST_REQUIRE(pool.next_index() == 3);
+    issued_address issued;
+    for (uint32_t index = 3; index < 40; ++index)
+    {
+        BOOST_REQUIRE(pool.next_address(issued));
+        BOOST_REQUIRE(issued.index == index);
+        BOOST_REQUIRE(issued.address.encoded() ==
+            account.generate_public_key(index).address().encoded());
+    }
+    BOOST_REQUIRE(pool.next_index() == 40);
+    BOOST_REQUIRE(pool.size() <= 8);
+
+    // Runs out at the first hardened index:
+    address_pool last(account, first_hardened_key - 2);
+    BOOST_REQUIRE(last.next_address(issued));
+    BOOST_REQUIRE(last.next_address(issued));
+    BOOST_REQUIRE(issued.index == first_hardened_key - 1);
+    BOOST_REQUIRE(!last.next_address(issued));
+    BOOST_REQUIRE(last.next_index() == first_hardened_key);
+
+    address_pool invalid((hd_public_key()));
+    BOOST_REQUIRE(!invalid.next_address(issued));
+}
+
+BOOST_AUTO_TEST_CASE(address_pool_threads_test)
+{
+    const hd_public_key account = test_account();
+    address_pool pool(account, 0, 16, 4);
+
+    // Every index is issued exactly once across threads:
+    const size_t threads = 4;
+    const size_t per_thread = 100;
+    std::vector<uint32_t> indexes;
+    std::mutex mutex;
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < threads; ++i)
+        workers.emplace_back([&]()
+        {
+            std::vector<uint32_t> taken;
+            issued_address issued;
+            for (size_t n = 0; n < per_thread; ++n)
+            {
+                if (!pool.next_address(issued))
+                    return;
+                taken.push_back(issued.index);
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            indexes.insert(indexes.end(), taken.begin(), taken.end());
+        });
+    for (std::thread& worker: workers)
+        worker.join();
+
+    std::sort(indexes.begin(), indexes.end());
+    BOOST_REQUIRE(indexes.size() == threads * per_thread);
+    for (size_t i = 0; i < indexes.size(); ++i)
+        BOOST_REQUIRE(indexes[i] == i);
+    BOOST_REQUIRE(pool.next_index() == threads * per_thread);
+}
+
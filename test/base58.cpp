@@ -0,0 +1,75 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <random>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <wallet/base58.hpp>
+
+using namespace libwallet;
+
+BOOST_AUTO_TEST_CASE(base58_fixed_test)
+{
+    // Address 113Pfw4sFqN1T5kXUnKbqZHMJHN9oyjtgD with its checksum:
+    byte_array<25> raw;
+    BOOST_REQUIRE(decode_base58_fixed(
+        "113Pfw4sFqN1T5kXUnKbqZHMJHN9oyjtgD", raw));
+    BOOST_REQUIRE(raw[0] == 0 && raw[1] == 0);
+    BOOST_REQUIRE(encode_base58_fixed(raw) ==
+        "113Pfw4sFqN1T5kXUnKbqZHMJHN9oyjtgD");
+
+    byte_array<21> payload;
+    BOOST_REQUIRE(decode_base58check_fixed(
+        "113Pfw4sFqN1T5kXUnKbqZHMJHN9oyjtgD", payload));
+    BOOST_REQUIRE(std::equal(payload.begin(), payload.end(), raw.begin()));
+    BOOST_REQUIRE(encode_base58check_fixed(payload) ==
+        "113Pfw4sFqN1T5kXUnKbqZHMJHN9oyjtgD");
+
+    // Wrong length, checksum and alphabet:
+    byte_array<24> short_raw;
+    BOOST_REQUIRE(!decode_base58_fixed(
+        "113Pfw4sFqN1T5kXUnKbqZHMJHN9oyjtgD", short_raw));
+    BOOST_REQUIRE(!decode_base58check_fixed(
+        "113Pfw4sFqN1T5kXUnKbqZHMJHN9oyjtgE", payload));
+    BOOST_REQUIRE(!decode_base58_fixed(
+        "113Pfw4sFqN1T5kXUnKbqZHMJHN9oyjtg0", raw));
+
+    // Same results as libbitcoin for all sizes, with leading zeros:
+    std::mt19937 random(3);
+    for (size_t n = 0; n < 2000; ++n)
+    {
+        data_chunk data(n % base58_max_size + 1);
+        for (auto& byte: data)
+            byte = static_cast<uint8_t>(random());
+        for (size_t i = 0; i < n % 4 && i < data.size(); ++i)
+            data[i] = 0;
+        const std::string expected = encode_base58(data);
+
+        char text[base58_encoded_size(base58_max_size)];
+        const size_t length =
+            encode_base58_fixed(data.data(), data.size(), text);
+        BOOST_REQUIRE(std::string(text, length) == expected);
+
+        uint8_t decoded[base58_max_size];
+        BOOST_REQUIRE(decode_base58_fixed(expected.data(), expected.size(),
+            decoded, sizeof(decoded)) == data.size());
+        BOOST_REQUIRE(std::equal(data.begin(), data.end(), decoded));
+    }
+}
+
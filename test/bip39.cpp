@@ -0,0 +1,69 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <wallet/bip39.hpp>
+#include <wallet/hd_keys.hpp>
+
+using namespace libwallet;
+
+BOOST_AUTO_TEST_CASE(bip39_mnemonic_test)
+{
+    const data_chunk entropy(16, 0x7f);
+    const string_list words{
+        "legal", "winner", "thank", "year", "wave", "sausage",
+        "worth", "useful", "legal", "winner", "thank", "yellow"};
+    BOOST_REQUIRE(encode_bip39_mnemonic(entropy) == words);
+    BOOST_REQUIRE(decode_bip39_mnemonic(words) == entropy);
+    BOOST_REQUIRE(validate_bip39_mnemonic(words));
+
+    const data_chunk long_entropy(32, 0xff);
+    string_list long_words(23, "zoo");
+    long_words.push_back("vote");
+    BOOST_REQUIRE(encode_bip39_mnemonic(long_entropy) == long_words);
+    BOOST_REQUIRE(decode_bip39_mnemonic(long_words) == long_entropy);
+
+    // Bad checksum, unknown word, wrong lengths:
+    string_list bad_words = words;
+    bad_words.back() = "winner";
+    BOOST_REQUIRE(!validate_bip39_mnemonic(bad_words));
+    bad_words.back() = "yellowish";
+    BOOST_REQUIRE(!validate_bip39_mnemonic(bad_words));
+    bad_words.pop_back();
+    BOOST_REQUIRE(!validate_bip39_mnemonic(bad_words));
+    BOOST_REQUIRE(encode_bip39_mnemonic(data_chunk(15)).empty());
+}
+
+BOOST_AUTO_TEST_CASE(bip39_seed_test)
+{
+    string_list words(11, "abandon");
+    words.push_back("about");
+    BOOST_REQUIRE(encode_bip39_mnemonic(data_chunk(16, 0)) == words);
+
+    const data_chunk seed = bip39_to_seed(words, "TREZOR");
+    BOOST_REQUIRE(encode_hex(seed) ==
+        "c55257c360c07c72029aebc1b53c05ed0362ada38ead3e3e9efa3708e5349553"
+        "1f09a6987599d18264c1e1c92f2cf141630c7a3c4ab7c81b2f001698e7463b04");
+
+    hd_private_key master(seed);
+    BOOST_REQUIRE(master.serialize() ==
+        "xprv9s21ZrQH143K3h3fDYiay8mocZ3afhfULfb5GX8kCBdno77K4HiA15Tg23wp"
+        "beF1pLfs1c5SPmYHrEpTuuRhxMwvKDwqdKiGJS9XFKzUsAF");
+}
@@ -17,6 +17,8 @@
  * You should have received a copy of the GNU Affero General Public License
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
+#include <limits>
+#include <set>
 #include <boost/test/unit_test.hpp>
 #include <bitcoin/bitcoin.hpp>
 #include <wallet/wallet.hpp>
@@ -166,6 +168,10 @@ BOOST_AUTO_TEST_CASE(hd_keys_serialize)
     // Invalid public keys:
     BOOST_REQUIRE(!public_key.set_serialized(private_string));
     BOOST_REQUIRE(!public_key.set_serialized(public_string + ' '));
+    BOOST_REQUIRE(libwallet::hd_public_key().serialize().empty());
+    const libbitcoin::data_chunk uncompressed(65, 0x04);
+    BOOST_REQUIRE(libwallet::hd_public_key(uncompressed,
+        public_key.chain_code(), public_key.lineage()).serialize().empty());
 
     // Simple private key round trip:
     libwallet::hd_private_key private_key;
@@ -194,3 +200,56 @@ BOOST_AUTO_TEST_CASE(hd_keys_serialize_derive)
         "RUT3dKYnjwih2yJD9mkrocEZXo1ex8G81dwSM1fwqWpWkeS3v86pgKt");
 }
 
+BOOST_AUTO_TEST_CASE(hd_masters_test)
+{
+    // Known seeds give the same keys as hd_private_key:
+    std::vector<libbitcoin::data_chunk> seeds
+    {
+        libbitcoin::decode_hex("000102030405060708090a0b0c0d0e0f"),
+        libbitcoin::decode_hex(
+            "fffcf9f6f3f0edeae7e4e1dedbd8d5d2cfccc9c6c3c0bdbab7b4b1aeaba8a5a2"
+            "9f9c999693908d8a8784817e7b7875726f6c696663605d5a5754514e4b484542")
+    };
+    auto masters = libwallet::generate_hd_masters(seeds, false, 2);
+    BOOST_REQUIRE(masters.size() == seeds.size());
+    for (size_t i = 0; i < seeds.size(); ++i)
+    {
+        libwallet::hd_private_key key(seeds[i]);
+        BOOST_REQUIRE(masters[i].valid);
+        BOOST_REQUIRE(masters[i].seed == seeds[i]);
+        BOOST_REQUIRE(masters[i].private_key == key.serialize());
+        libwallet::hd_public_key& public_part = key;
+        BOOST_REQUIRE(masters[i].public_key == public_part.serialize());
+    }
+    BOOST_REQUIRE(masters[0].public_key ==
+        "xpub661MyMwAqRbcFtXgS5sYJABqqG9YLmC4Q1Rdap9gSE8NqtwybGhe"
+        "PY2gZ29ESFjqJoCu1Rupje8YtGqsefD265TMg7usUDFdp6W1EGMcet8");
+
+    // Random seeds, each of them distinct:
+    masters = libwallet::generate_hd_masters(100, 16, true);
+    BOOST_REQUIRE(masters.size() == 100);
+    std::set<libbitcoin::data_chunk> distinct;
+    for (const auto& master: masters)
+    {
+        BOOST_REQUIRE(master.valid);
+        BOOST_REQUIRE(master.seed.size() == 16);
+        distinct.insert(master.seed);
+        libwallet::hd_private_key key(master.seed, true);
+        BOOST_REQUIRE(master.private_key == key.serialize());
+        BOOST_REQUIRE(master.private_key.compare(0, 4, "tprv") == 0);
+        BOOST_REQUIRE(master.public_key.compare(0, 4, "tpub") == 0);
+    }
+    BOOST_REQUIRE(distinct.size() == masters.size());
+
+    // Seed sizes BIP 32 does not allow, and sizes that would overflow:
+    BOOST_REQUIRE(libwallet::generate_hd_masters(1, 0).empty());
+    BOOST_REQUIRE(libwallet::generate_hd_masters(1, 15).empty());
+    BOOST_REQUIRE(libwallet::generate_hd_masters(1, 65).empty());
+    BOOST_REQUIRE(libwallet::generate_hd_masters(
+        std::numeric_limits<size_t>::max() / 32 + 1, 32).empty());
+    masters = libwallet::generate_hd_masters(2, 64);
+    BOOST_REQUIRE(masters.size() == 2);
+    BOOST_REQUIRE(masters[0].seed.size() == 64);
+    BOOST_REQUIRE(masters[0].seed != masters[1].seed);
+}
+
@@ -17,7 +17,9 @@
  * You should have received a copy of the GNU Affero General Public License
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
+#include <random>
 #include <boost/test/unit_test.hpp>
+#include <bitcoin/bitcoin.hpp>
 #include <wallet/key_formats.hpp>
 
 using namespace libwallet;
@@ -47,3 +49,112 @@ BOOST_AUTO_TEST_CASE(wif_test)
     from_wif = wif_to_secret(uncompressed);
     BOOST_REQUIRE(std::equal(secret.begin(), secret.end(), from_wif.begin()));
 }
+
+BOOST_AUTO_TEST_CASE(decode_wif_test)
+{
+    const std::string compressed =
+        "L1WepftUBemj6H4XQovkiW1ARVjxMqaw4oj2kmkYqdG1xTnBcHfC";
+    wif_key key = decode_wif(compressed);
+    BOOST_REQUIRE(key.valid);
+    BOOST_REQUIRE(key.version == 0x80);
+    BOOST_REQUIRE(key.compressed);
+    BOOST_REQUIRE(key.secret[0] == 0x80 && key.secret[31] == 0x36);
+
+    // Bad checksum, character and length:
+    BOOST_REQUIRE(!decode_wif(
+        "L1WepftUBemj6H4XQovkiW1ARVjxMqaw4oj2kmkYqdG1xTnBcHfD").valid);
+    BOOST_REQUIRE(!decode_wif(
+        "L1WepftUBemj6H4XQovkiW1ARVjxMqaw4oj2kmkYqdG1xTnBcHf0").valid);
+    BOOST_REQUIRE(!decode_wif(
+        "1L1WepftUBemj6H4XQovkiW1ARVjxMqaw4oj2kmkYqdG1xTnBcHfC").valid);
+    BOOST_REQUIRE(!decode_wif("").valid);
+    BOOST_REQUIRE(wif_to_secret("5Hue") == ec_secret());
+    BOOST_REQUIRE(!is_wif_compressed("5Hue"));
+
+    // Same encoding as building it with the libbitcoin helpers:
+    std::mt19937 random(7);
+    for (size_t n = 0; n < 200; ++n)
+    {
+        ec_secret secret;
+        for (auto& byte: secret)
+            byte = static_cast<uint8_t>(random());
+        // Exercise leading zeros too.
+        if (n % 4 == 0)
+            secret[0] = 0;
+        const bool compressed = n % 2 == 0;
+        data_chunk data{payment_address::wif_version};
+        extend_data(data, secret);
+        if (compressed)
+            data.push_back(0x01);
+        append_checksum(data);
+        const std::string wif = encode_base58(data);
+
+        BOOST_REQUIRE(secret_to_wif(secret, compressed) == wif);
+        key = decode_wif(wif);
+        BOOST_REQUIRE(key.valid);
+        BOOST_REQUIRE(key.compressed == compressed);
+        BOOST_REQUIRE(key.secret == secret);
+    }
+}
+
+BOOST_AUTO_TEST_CASE(import_keys_test)
+{
+    std::vector<std::string> keys{
+        "L1WepftUBemj6H4XQovkiW1ARVjxMqaw4oj2kmkYqdG1xTnBcHfC",
+        "not a key",
+        "5JngqQmHagNTknnCshzVUysLMWAjT23FWs1TgNU5wyFH5SB3hrP",
+        "S6c56bnXQiBjk9mqSYE7ykVQ7NzrRy",
+        "S6c56bnXQiBjk9mqSYE7ykVQ7NzrRz"};
+    // Enough keys to share between threads:
+    for (size_t i = 0; i < 200; ++i)
+        keys.push_back(keys[i % 5]);
+
+    const auto result = import_keys(keys, 4);
+    BOOST_REQUIRE(result.keys.size() == keys.size());
+    BOOST_REQUIRE(result.invalid.size() == 2 * 41);
+    BOOST_REQUIRE(result.invalid[0] == 1);
+    BOOST_REQUIRE(result.invalid[1] == 4);
+
+    const imported_key& compressed = result.keys[0];
+    BOOST_REQUIRE(compressed.valid && compressed.compressed);
+    BOOST_REQUIRE(compressed.public_key ==
+        secret_to_public_key(wif_to_secret(keys[0]), true));
+    BOOST_REQUIRE(compressed.hash ==
+        bitcoin_short_hash(compressed.public_key));
+
+    const imported_key& uncompressed = result.keys[2];
+    BOOST_REQUIRE(uncompressed.valid && !uncompressed.compressed);
+    BOOST_REQUIRE(uncompressed.secret == compressed.secret);
+    BOOST_REQUIRE(uncompressed.public_key.size() == 65);
+
+    const imported_key& minikey = result.keys[3];
+    BOOST_REQUIRE(minikey.valid && !minikey.compressed);
+    BOOST_REQUIRE(minikey.secret == minikey_to_secret(keys[3]));
+    BOOST_REQUIRE(!result.keys[1].valid);
+    BOOST_REQUIRE(result.keys[1].secret == ec_secret());
+}
+
+BOOST_AUTO_TEST_CASE(minikey_batch_test)
+{
+    BOOST_REQUIRE(check_minikey("S6c56bnXQiBjk9mqSYE7ykVQ7NzrRy"));
+    BOOST_REQUIRE(!check_minikey("S6c56bnXQiBjk9mqSYE7ykVQ7NzrRz"));
+    BOOST_REQUIRE(!check_minikey("S6c56bnXQiBjk9mqSYE7yk"));
+
+    const auto minikeys = generate_minikeys(300, 4);
+    BOOST_REQUIRE(minikeys.size() == 300);
+    for (const std::string& minikey: minikeys)
+    {
+        BOOST_REQUIRE(minikey.size() == 30);
+        BOOST_REQUIRE(minikey[0] == 'S');
+        BOOST_REQUIRE(minikey_to_secret(minikey) != ec_secret());
+    }
+    BOOST_REQUIRE(minikeys[0] != minikeys[1]);
+
+    auto batch = minikeys;
+    batch[7] = "S6c56bnXQiBjk9mqSYE7ykVQ7NzrRz";
+    batch[250] = "";
+    const auto invalid = validate_minikeys(batch, 4);
+    BOOST_REQUIRE(invalid.size() == 2);
+    BOOST_REQUIRE(invalid[0] == 7 && invalid[1] == 250);
+}
+
@@ -0,0 +1,111 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <boost/test/unit_test.hpp>
+#include <wallet/electrum_keys.hpp>
+#include <wallet/mnemonic.hpp>
+#include <wallet/mnemonic_recovery.hpp>
+
+using namespace libwallet;
+
+BOOST_AUTO_TEST_CASE(mnemonic_test)
+{
+    const std::string seed = "a219213f9b12422aa206d988e3e49607";
+    const string_list words{
+        "wrote", "book", "weakness", "even", "yet", "cell",
+        "lick", "suspend", "fought", "square", "destination", "shy"};
+
+    BOOST_REQUIRE(encode_mnemonic(seed) == words);
+    // decode_mnemonic() returns the seed after a leading newline.
+    BOOST_REQUIRE(decode_mnemonic(words) == "\n" + seed);
+}
+
+BOOST_AUTO_TEST_CASE(mnemonic_word_index_test)
+{
+    BOOST_REQUIRE(mnemonic_word_index("like", 4) == 0);
+    BOOST_REQUIRE(mnemonic_word_index("weary", 5) == 1625);
+    BOOST_REQUIRE(mnemonic_word_index("likely", 4) == 0);
+    BOOST_REQUIRE(mnemonic_word_index("lik", 3) == mnemonic_word_count);
+    BOOST_REQUIRE(mnemonic_word_index("", 0) == mnemonic_word_count);
+    BOOST_REQUIRE(std::string(mnemonic_word(1625)) == "weary");
+    BOOST_REQUIRE(mnemonic_word(mnemonic_word_count) == nullptr);
+}
+
+BOOST_AUTO_TEST_CASE(mnemonic_indexes_test)
+{
+    const std::string seed = "a219213f9b12422aa206d988e3e49607";
+    mnemonic_index indexes[12];
+    BOOST_REQUIRE(encode_mnemonic(seed.data(), seed.size(), indexes));
+    const string_list words = encode_mnemonic(seed);
+    for (size_t i = 0; i < 12; ++i)
+        BOOST_REQUIRE(words[i] == mnemonic_word(indexes[i]));
+
+    char decoded[32];
+    BOOST_REQUIRE(decode_mnemonic(indexes, 12, decoded));
+    BOOST_REQUIRE(std::string(decoded, sizeof(decoded)) == seed);
+
+    // Small values keep their leading zeros:
+    const std::string small = "0000000100000000";
+    BOOST_REQUIRE(encode_mnemonic(small.data(), small.size(), indexes));
+    BOOST_REQUIRE(decode_mnemonic(indexes, 6, decoded));
+    BOOST_REQUIRE(std::string(decoded, 16) == small);
+
+    // Invalid input:
+    BOOST_REQUIRE(!encode_mnemonic("0000000g", 8, indexes));
+    indexes[1] = mnemonic_word_count;
+    BOOST_REQUIRE(!decode_mnemonic(indexes, 3, decoded));
+}
+
+BOOST_AUTO_TEST_CASE(mnemonic_recovery_test)
+{
+    deterministic_wallet wallet;
+    BOOST_REQUIRE(wallet.set_seed("a219213f9b12422aa206d988e3e49607"));
+    const string_list words{
+        "wrote", "book", "weaknes", "even", "yet", "cell",
+        "lick", "suspend", "fought", "square", "destination", "shy"};
+
+    mnemonic_recovery recovery(words, 1);
+    BOOST_REQUIRE(recovery.candidate_count() ==
+        recovery.candidates()[2].size());
+    BOOST_REQUIRE(mnemonic_word(recovery.candidates()[2][0]) ==
+        std::string("weakness"));
+
+    mnemonic_recovery_target target{
+        wallet.master_public_key(), payment_address(), 0, false};
+    string_list found;
+    BOOST_REQUIRE(recovery.recover(target, found));
+    BOOST_REQUIRE(found == encode_mnemonic(wallet.seed()));
+
+    // A word nowhere near the list may be any word:
+    string_list garbled = words;
+    garbled[2] = "qqqqqqqqqqqq";
+    mnemonic_recovery garbled_recovery(garbled, 1);
+    BOOST_REQUIRE(garbled_recovery.candidates()[2].size() ==
+        mnemonic_word_count);
+
+    // Stopping before recovery starts is not lost:
+    mnemonic_recovery stopped(words, 1);
+    stopped.stop();
+    BOOST_REQUIRE(!stopped.recover(target, found));
+
+    // Phrases that are not 12 words long have no candidates.
+    mnemonic_recovery short_recovery(string_list{"wrote", "book", ""});
+    BOOST_REQUIRE(short_recovery.candidate_count() == 0);
+    BOOST_REQUIRE(!short_recovery.recover(target, found));
+}
@@ -0,0 +1,85 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <algorithm>
+#include <thread>
+#include <vector>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <wallet/random.hpp>
+
+using namespace libwallet;
+
+BOOST_AUTO_TEST_CASE(chacha20_block_test)
+{
+    // RFC 7539 appendix A.1 test vectors 1 to 3, which use a zero nonce:
+    uint8_t key[chacha20_key_size] = {};
+    uint8_t block[chacha20_block_size];
+    chacha20_block(key, 0, block);
+    BOOST_REQUIRE(encode_hex(data_chunk(block, block + sizeof(block))) ==
+        "76b8e0ada0f13d90405d6ae55386bd28bdd219b8a08ded1aa836efcc8b770dc7"
+        "da41597c5157488d7724e03fb8d84a376a43b8f41518a11cc387b669b2ee6586");
+    chacha20_block(key, 1, block);
+    BOOST_REQUIRE(encode_hex(data_chunk(block, block + sizeof(block))) ==
+        "9f07e7be5551387a98ba977c732d080dcb0f29a048e3656912c6533e32ee7aed"
+        "29b721769ce64e43d57133b074d839d531ed1f28510afb45ace10a1f4b794d6f");
+    key[31] = 1;
+    chacha20_block(key, 1, block);
+    BOOST_REQUIRE(encode_hex(data_chunk(block, block + sizeof(block))) ==
+        "3aeb5224ecf849929b9d828db1ced4dd832025e8018b8160b82284f3c949aa5a"
+        "8eca00bbb4a73bdad192b5c42f73f2fd4e273644c8b36125a64addeb006c13a0");
+
+    // The high half of the counter goes in the next word:
+    key[31] = 0;
+    chacha20_block(key, uint64_t(1) << 32, block);
+    BOOST_REQUIRE(encode_hex(data_chunk(block, block + sizeof(block))) ==
+        "3db41d3aa0d329285de6f225e6e24bd59c9a17006943d5c9b680e3873bdc683a"
+        "5819469899989690c281cd17c96159af0682b5b903468a61f50228cf09622b5a");
+}
+
+BOOST_AUTO_TEST_CASE(random_test)
+{
+    // Nothing stuck, repeated or zeroed across refills and threads:
+    std::vector<data_chunk> draws(8, data_chunk(5000));
+    std::vector<std::thread> threads;
+    for (auto& draw: draws)
+        threads.emplace_back([&draw]()
+        {
+            random_fill(draw.data(), 1);
+            random_fill(draw.data() + 1, draw.size() - 1);
+        });
+    for (auto& thread: threads)
+        thread.join();
+    for (size_t i = 0; i < draws.size(); ++i)
+    {
+        size_t counts[256] = {};
+        for (uint8_t byte: draws[i])
+            ++counts[byte];
+        BOOST_REQUIRE(*std::max_element(counts, counts + 256) < 60);
+        for (size_t j = 0; j < i; ++j)
+            BOOST_REQUIRE(draws[i] != draws[j]);
+    }
+
+    const ec_secret secret = new_secret();
+    BOOST_REQUIRE(verify_private_key(secret));
+    BOOST_REQUIRE(secret != new_secret());
+    uint8_t system[32] = {};
+    BOOST_REQUIRE(system_random_fill(system, sizeof(system)));
+}
+
@@ -84,3 +84,38 @@ BOOST_AUTO_TEST_CASE(stealth_addr_encoding)
     BOOST_REQUIRE(addr.encoded() == addr_str);
 }
 
+
+BOOST_AUTO_TEST_CASE(stealth_addr_decode_boundary)
+{
+    // Two spend keys and trailing bytes take the payload with its checksum
+    // to 129 bytes, yet the encoding is short enough for the fixed decoder
+    // to be tried first.
+    data_chunk raw{0x2a, 0x00};
+    raw.resize(2 + 33, 0x02);
+    raw.push_back(2);
+    raw.resize(raw.size() + 2 * 33, 0x03);
+    raw.push_back(1);
+    raw.push_back(0);
+    const data_chunk prefix = raw;
+    raw.resize(125, 0xff);
+    append_checksum(raw);
+    const std::string encoded = encode_base58(raw);
+    BOOST_REQUIRE(raw.size() > libwallet::base58_max_size);
+    BOOST_REQUIRE(encoded.size() <=
+        libwallet::base58_encoded_size(libwallet::base58_max_size));
+
+    libwallet::stealth_address addr;
+    BOOST_REQUIRE(addr.set_encoded(encoded));
+    BOOST_REQUIRE(addr.scan_pubkey == ec_point(raw.begin() + 2,
+        raw.begin() + 35));
+    BOOST_REQUIRE(addr.spend_pubkeys.size() == 2);
+    BOOST_REQUIRE(addr.number_signatures == 1);
+
+    // The trailing bytes are not part of the address, so they are dropped.
+    data_chunk expected = prefix;
+    append_checksum(expected);
+    BOOST_REQUIRE(addr.encoded() == encode_base58(expected));
+    libwallet::stealth_address again;
+    BOOST_REQUIRE(again.set_encoded(addr.encoded()));
+    BOOST_REQUIRE(again.encoded() == addr.encoded());
+}
@@ -0,0 +1,380 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <mutex>
+#include <set>
+#include <thread>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <wallet/transaction.hpp>
+#include <wallet/utxo_pool.hpp>
+#include <wallet/utxo_selector.hpp>
+
+using namespace libwallet;
+
+static output_info_list make_unspent(const std::vector<uint64_t>& values)
+{
+    output_info_list unspent;
+    for (size_t i = 0; i < values.size(); ++i)
+    {
+        output_info_type info;
+        info.point.hash = null_hash;
+        info.point.index = static_cast<uint32_t>(i);
+        info.value = values[i];
+        unspent.push_back(info);
+    }
+    return unspent;
+}
+
+static uint64_t selected_value(const output_info_list& unspent,
+    const select_outputs_result& result)
+{
+    uint64_t total = 0;
+    for (const output_point& point: result.points)
+        total += unspent[point.index].value;
+    return total;
+}
+
+BOOST_AUTO_TEST_CASE(select_outputs_greedy_test)
+{
+    const auto unspent = make_unspent({500, 100, 2000, 300, 1000});
+
+    // Smallest single output covering the value:
+    auto result = select_outputs(unspent, 900);
+    BOOST_REQUIRE(result.points.size() == 1);
+    BOOST_REQUIRE(result.points[0].index == 4);
+    BOOST_REQUIRE(result.change == 100);
+
+    // Largest outputs first when no single output is enough:
+    result = select_outputs(unspent, 3200);
+    BOOST_REQUIRE(result.points.size() == 3);
+    BOOST_REQUIRE(result.change == 300);
+
+    BOOST_REQUIRE(select_outputs(unspent, 5000).points.empty());
+    BOOST_REQUIRE(select_outputs(output_info_list(), 1).points.empty());
+
+    // Any contiguous range of outputs:
+    result = select_outputs(unspent.data() + 1, unspent.data() + 4, 900);
+    BOOST_REQUIRE(result.points.size() == 1);
+    BOOST_REQUIRE(result.points[0].index == 2);
+    BOOST_REQUIRE(result.change == 1100);
+    BOOST_REQUIRE(select_outputs(unspent.data(), unspent.data(),
+        1).points.empty());
+}
+
+BOOST_AUTO_TEST_CASE(select_outputs_algorithms_test)
+{
+    const auto unspent = make_unspent({500, 100, 2000, 300, 1000, 700});
+
+    auto result = select_outputs(unspent, 1200,
+        select_outputs_algorithm::branch_and_bound);
+    BOOST_REQUIRE(!result.points.empty());
+    BOOST_REQUIRE(selected_value(unspent, result) == 1200);
+    BOOST_REQUIRE(result.change == 0);
+    BOOST_REQUIRE(select_outputs(unspent, 50,
+        select_outputs_algorithm::branch_and_bound).points.empty());
+
+    result = select_outputs(unspent, 1250,
+        select_outputs_algorithm::knapsack);
+    BOOST_REQUIRE(selected_value(unspent, result) == 1300);
+    BOOST_REQUIRE(result.change == 50);
+
+    result = select_outputs(unspent, 2500,
+        select_outputs_algorithm::largest_first);
+    BOOST_REQUIRE(result.points.size() == 2);
+    BOOST_REQUIRE(result.change == 500);
+
+    result = select_outputs(unspent, 850,
+        select_outputs_algorithm::smallest_first);
+    BOOST_REQUIRE(result.points.size() == 3);
+    BOOST_REQUIRE(result.change == 50);
+}
+
+BOOST_AUTO_TEST_CASE(utxo_pool_test)
+{
+    const auto unspent = make_unspent({500, 100, 2000, 300, 1000, 700});
+    utxo_pool pool(unspent);
+    BOOST_REQUIRE(pool.size() == 6);
+    BOOST_REQUIRE(pool.total_value() == 4600);
+    BOOST_REQUIRE(!pool.insert(unspent[0]));
+
+    // Same choices as select_outputs():
+    for (uint64_t value: {50, 900, 2500, 3500, 4600, 4700})
+    {
+        auto expected = select_outputs(unspent, value);
+        auto result = pool.select(value);
+        BOOST_REQUIRE(result.points.size() == expected.points.size());
+        BOOST_REQUIRE(result.change == expected.change);
+    }
+
+    auto result = pool.select(1200,
+        select_outputs_algorithm::branch_and_bound);
+    BOOST_REQUIRE(result.change == 0);
+    BOOST_REQUIRE(selected_value(unspent, result) == 1200);
+
+    result = pool.select(850, select_outputs_algorithm::smallest_first);
+    BOOST_REQUIRE(result.points.size() == 3);
+    pool.spend(result);
+    BOOST_REQUIRE(pool.size() == 3);
+    BOOST_REQUIRE(pool.total_value() == 3700);
+    BOOST_REQUIRE(!pool.contains(result.points[0]));
+    BOOST_REQUIRE(!pool.remove(result.points[0]));
+    BOOST_REQUIRE(pool.outputs().front().value == 700);
+}
+
+BOOST_AUTO_TEST_CASE(select_outputs_fee_test)
+{
+    // 1480 per input, 440 base, 340 for change.
+    const auto unspent = make_unspent({5000, 1000, 20000, 1400, 10000});
+    const select_outputs_fee fee(10000);
+
+    // Excess too small for change goes to the fee:
+    auto result = select_outputs(unspent, 8000, fee);
+    BOOST_REQUIRE(result.points.size() == 1);
+    BOOST_REQUIRE(result.points[0].index == 4);
+    BOOST_REQUIRE(result.change == 0);
+    BOOST_REQUIRE(result.fee == 2000);
+
+    result = select_outputs(unspent, 5000, fee);
+    BOOST_REQUIRE(result.points.size() == 1);
+    BOOST_REQUIRE(result.change == 2740);
+    BOOST_REQUIRE(result.fee == 2260);
+
+    // Outputs worth less than their input fee are never spent:
+    result = select_outputs(unspent, 28000, fee,
+        select_outputs_algorithm::smallest_first);
+    BOOST_REQUIRE(result.points.size() == 3);
+    BOOST_REQUIRE(selected_value(unspent, result) == 35000);
+    BOOST_REQUIRE(selected_value(unspent, result) ==
+        28000 + result.fee + result.change);
+    BOOST_REQUIRE(select_outputs(unspent, 31000, fee).points.empty());
+
+    result = select_outputs(unspent, 3000, fee,
+        select_outputs_algorithm::branch_and_bound);
+    BOOST_REQUIRE(result.points.size() == 1);
+    BOOST_REQUIRE(result.change == 0);
+    BOOST_REQUIRE(result.fee == 2000);
+
+    utxo_pool pool(unspent);
+    for (uint64_t value: {3000, 5000, 8000, 20000, 28000, 31000})
+    {
+        auto expected = select_outputs(unspent, value, fee);
+        result = pool.select(value, fee);
+        BOOST_REQUIRE(result.points.size() == expected.points.size());
+        BOOST_REQUIRE(result.change == expected.change);
+        BOOST_REQUIRE(result.fee == expected.fee);
+    }
+
+    // No fee and no dust threshold still finds exact matches:
+    select_outputs_fee free(0);
+    free.dust_threshold = 0;
+    result = select_outputs(unspent, 6000, free,
+        select_outputs_algorithm::branch_and_bound);
+    BOOST_REQUIRE(result.points.size() == 2);
+    BOOST_REQUIRE(selected_value(unspent, result) == 6000);
+    BOOST_REQUIRE(result.change == 0 && result.fee == 0);
+    result = pool.select(6000, free,
+        select_outputs_algorithm::branch_and_bound);
+    BOOST_REQUIRE(result.points.size() == 2);
+    BOOST_REQUIRE(result.change == 0 && result.fee == 0);
+}
+
+BOOST_AUTO_TEST_CASE(utxo_selector_test)
+{
+    const auto unspent = make_unspent({500, 100, 2000, 300, 1000, 700});
+    utxo_selector selector(unspent);
+
+    auto first = selector.reserve(900);
+    BOOST_REQUIRE(first.id != 0);
+    BOOST_REQUIRE(first.selection.points.size() == 1);
+    BOOST_REQUIRE(selector.reserved_value() == 1000);
+    BOOST_REQUIRE(!selector.insert(unspent[4]));
+
+    // The reserved output is not chosen again:
+    auto second = selector.reserve(900);
+    BOOST_REQUIRE(second.id != first.id);
+    BOOST_REQUIRE(second.selection.points[0].index == 2);
+
+    BOOST_REQUIRE(selector.release(first.id));
+    BOOST_REQUIRE(!selector.release(first.id));
+    BOOST_REQUIRE(selector.commit(second.id));
+    BOOST_REQUIRE(selector.available_value() == 2600);
+    BOOST_REQUIRE(selector.reserved_size() == 0);
+    BOOST_REQUIRE(selector.reserve(2700).id == 0);
+}
+
+BOOST_AUTO_TEST_CASE(utxo_selector_threads_test)
+{
+    std::vector<uint64_t> values;
+    for (uint64_t i = 1; i <= 1000; ++i)
+        values.push_back(i * 100);
+    const auto unspent = make_unspent(values);
+    utxo_selector selector(unspent);
+
+    std::mutex mutex;
+    std::set<uint32_t> spent;
+    bool double_spent = false;
+    auto work = [&]()
+    {
+        for (size_t n = 0; n < 200; ++n)
+        {
+            // Knapsack searches outside the lock and claims afterwards.
+            const auto alg = n % 2 ? select_outputs_algorithm::knapsack :
+                select_outputs_algorithm::smallest_first;
+            auto reservation = selector.reserve(5000, alg, 1000);
+            if (!reservation.id)
+                break;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                for (const output_point& point: reservation.selection.points)
+                    if (!spent.insert(point.index).second)
+                        double_spent = true;
+            }
+            selector.commit(reservation.id);
+        }
+    };
+    std::vector<std::thread> workers;
+    for (size_t i = 0; i < 4; ++i)
+        workers.emplace_back(work);
+    for (std::thread& worker: workers)
+        worker.join();
+
+    BOOST_REQUIRE(!double_spent);
+    BOOST_REQUIRE(selector.reserved_size() == 0);
+    BOOST_REQUIRE(selector.available_size() + spent.size() == 1000);
+}
+
+BOOST_AUTO_TEST_CASE(utxo_pool_batch_test)
+{
+    const auto unspent = make_unspent({5000, 20000, 10000, 8000});
+    utxo_pool pool(unspent);
+    const select_outputs_fee fee(10000);
+    const std::vector<uint64_t> amounts{1000, 2000, 3000, 4000};
+
+    // One transaction paying everyone:
+    auto batch = pool.select_batch(amounts, fee);
+    BOOST_REQUIRE(batch.size() == 1);
+    BOOST_REQUIRE(batch[0].payments.size() == 4);
+    BOOST_REQUIRE(selected_value(unspent, batch[0].selection) ==
+        10000 + batch[0].selection.fee + batch[0].selection.change);
+    BOOST_REQUIRE(pool.size() == 4);
+
+    // Room for two payments and one input per transaction:
+    batch = pool.select_batch(amounts, fee, 260);
+    BOOST_REQUIRE(batch.size() == 2);
+    BOOST_REQUIRE(batch[1].payments.front() == 2);
+    BOOST_REQUIRE(batch[0].selection.points.size() == 1);
+    BOOST_REQUIRE(batch[1].selection.points.size() == 1);
+    BOOST_REQUIRE(batch[0].selection.points[0].index !=
+        batch[1].selection.points[0].index);
+    BOOST_REQUIRE(pool.total_value() == 43000);
+
+    BOOST_REQUIRE(pool.select_batch({40000, 4000}, fee).empty());
+    BOOST_REQUIRE(pool.select_batch(amounts, fee, 100).empty());
+    BOOST_REQUIRE(pool.size() == 4);
+
+    // Outputs of no size never limit the payments per transaction:
+    select_outputs_fee unsized(fee);
+    unsized.output_size = 0;
+    batch = pool.select_batch(amounts, unsized, 1000);
+    BOOST_REQUIRE(batch.size() == 1);
+    BOOST_REQUIRE(batch[0].payments.size() == 4);
+
+    // Copies are independent:
+    utxo_pool copy(pool);
+    copy.spend(batch[0].selection);
+    BOOST_REQUIRE(copy.size() == 3);
+    BOOST_REQUIRE(pool.size() == 4);
+
+    // Each payment has an exact match but the two together do not, so
+    // branch_and_bound needs two transactions. Without a size limit only
+    // one is tried.
+    select_outputs_fee exact(1000);
+    exact.base_size = 100;
+    exact.dust_threshold = 0;
+    utxo_pool matches(make_unspent({1282, 2282}));
+    BOOST_REQUIRE(matches.select_batch({1000, 2000}, exact, 0,
+        select_outputs_algorithm::branch_and_bound).empty());
+    batch = matches.select_batch({1000, 2000}, exact, 1000,
+        select_outputs_algorithm::branch_and_bound);
+    BOOST_REQUIRE(batch.size() == 2);
+    BOOST_REQUIRE(batch[0].selection.change == 0);
+    BOOST_REQUIRE(batch[1].selection.change == 0);
+}
+
+// Replays deposits (positive) and payments (negative) through a
+// utxo_pool, as examples/select_outputs does for recorded streams, and
+// returns the unspent output count after each step.
+static std::vector<size_t> replay(const std::vector<int64_t>& stream,
+    select_outputs_algorithm alg, const select_outputs_fee& fee)
+{
+    utxo_pool pool;
+    uint32_t next_index = 0;
+    auto add_output = [&](uint64_t value)
+    {
+        output_info_type output;
+        output.point.hash = null_hash;
+        output.point.index = next_index++;
+        output.value = value;
+        pool.insert(output);
+    };
+
+    std::vector<size_t> sizes;
+    for (const int64_t event: stream)
+    {
+        if (event > 0)
+            add_output(event);
+        else
+        {
+            const uint64_t value = -event;
+            const auto result = pool.select(value, fee, alg);
+            if (!result.points.empty())
+            {
+                const uint64_t before = pool.total_value();
+                pool.spend(result);
+                BOOST_REQUIRE(before - pool.total_value() ==
+                    value + result.fee + result.change);
+                if (result.change)
+                    add_output(result.change);
+            }
+        }
+        sizes.push_back(pool.size());
+    }
+    return sizes;
+}
+
+BOOST_AUTO_TEST_CASE(select_outputs_replay_test)
+{
+    const std::vector<int64_t> stream{
+        50000, 30000, 20000, 10000, -25000, -100000, 200000, -60000,
+        -5000, 40000, -90000};
+    const select_outputs_fee fee(10000);
+
+    // Greedy takes the smallest single output that covers each payment,
+    // so every funded payment spends one output and makes change.
+    BOOST_REQUIRE(replay(stream, select_outputs_algorithm::greedy, fee) ==
+        std::vector<size_t>({1, 2, 3, 4, 4, 4, 5, 5, 5, 6, 6}));
+
+    // Smallest first consolidates, except for outputs worth less than the
+    // fee to spend them, like the 1260 change from the first payment.
+    BOOST_REQUIRE(
+        replay(stream, select_outputs_algorithm::smallest_first, fee) ==
+        std::vector<size_t>({1, 2, 3, 4, 3, 3, 4, 3, 3, 4, 2}));
+}
+
@@ -146,6 +146,13 @@ BOOST_AUTO_TEST_CASE(uri_parse_strict_test)
         "bitcoin:?label=Some テスト", result, false));
     BOOST_REQUIRE(result.label && result.label.get() == "Some テスト");
 
+    // Lenient parsing still decodes escapes, and keeps stray '%':
+    BOOST_REQUIRE(libwallet::uri_parse(
+        "bitcoin:?message=hello%20bitcoin&label=100%", result, false));
+    BOOST_REQUIRE(result.message &&
+        result.message.get() == "hello bitcoin");
+    BOOST_REQUIRE(result.label && result.label.get() == "100%");
+
     // Strict parsing:
     BOOST_REQUIRE(!libwallet::uri_parse(
         "bitcoin:?label=Some テスト", result, true));
@@ -223,6 +230,72 @@ BOOST_AUTO_TEST_CASE(uri_parse_custom_test)
     BOOST_REQUIRE(custom.myparam && custom.myparam.get() == "here");
 }
 
+class view_counter
+  : public libwallet::uri_view_visitor
+{
+public:
+    view_counter(const std::string& uri)
+      : copies(0), params(0), uri_(uri)
+    {
+    }
+
+    bool got_address(boost::string_ref address)
+    {
+        count(address);
+        this->address = address.to_string();
+        return true;
+    }
+
+    bool got_param(boost::string_ref key, boost::string_ref value)
+    {
+        count(key);
+        count(value);
+        ++params;
+        last = value.to_string();
+        return true;
+    }
+
+    std::string address;
+    std::string last;
+
+    // Components not pointing into the original URI:
+    size_t copies;
+    size_t params;
+
+private:
+    void count(boost::string_ref view)
+    {
+        if (!view.empty() && (view.data() < uri_.data() ||
+            view.data() >= uri_.data() + uri_.size()))
+            ++copies;
+    }
+
+    const std::string& uri_;
+};
+
+BOOST_AUTO_TEST_CASE(uri_parse_view_test)
+{
+    const std::string plain =
+        "bitcoin:113Pfw4sFqN1T5kXUnKbqZHMJHN9oyjtgD?amount=0.1&label=test";
+    view_counter counter(plain);
+    BOOST_REQUIRE(libwallet::uri_parse(boost::string_ref(plain), counter));
+    BOOST_REQUIRE(counter.address == "113Pfw4sFqN1T5kXUnKbqZHMJHN9oyjtgD");
+    BOOST_REQUIRE(counter.params == 2);
+    BOOST_REQUIRE(counter.last == "test");
+    BOOST_REQUIRE(counter.copies == 0);
+
+    // Only the escaped component is unescaped elsewhere:
+    const std::string escaped = "bitcoin:?amount=1&message=hello%20bitcoin";
+    view_counter escaped_counter(escaped);
+    BOOST_REQUIRE(libwallet::uri_parse(
+        boost::string_ref(escaped), escaped_counter));
+    BOOST_REQUIRE(escaped_counter.last == "hello bitcoin");
+    BOOST_REQUIRE(escaped_counter.copies == 1);
+
+    BOOST_REQUIRE(!libwallet::uri_parse(
+        boost::string_ref("bitcoin:?=y"), escaped_counter));
+}
+
 BOOST_AUTO_TEST_CASE(parse_amount_test)
 {
     BOOST_REQUIRE(libwallet::parse_amount("4.432") == 443200000);
@@ -240,6 +313,33 @@ BOOST_AUTO_TEST_CASE(parse_amount_test)
     BOOST_REQUIRE(libwallet::parse_amount("21000000") == 2100000000000000);
     BOOST_REQUIRE(libwallet::parse_amount("1234.9", 0) == 1235);
     BOOST_REQUIRE(libwallet::parse_amount("64.25", 5) == 6425000);
+
+    // Long digit runs and overflow:
+    BOOST_REQUIRE(libwallet::parse_amount("12345678901234567890", 0) ==
+        12345678901234567890u);
+    BOOST_REQUIRE(libwallet::parse_amount("18446744073709551614", 0) ==
+        18446744073709551614u);
+    BOOST_REQUIRE(libwallet::parse_amount("18446744073709551615", 0) ==
+        libwallet::invalid_amount);
+    BOOST_REQUIRE(libwallet::parse_amount("18446744073709551616", 0) ==
+        libwallet::invalid_amount);
+    BOOST_REQUIRE(libwallet::parse_amount("184467440737.09551615") ==
+        libwallet::invalid_amount);
+    BOOST_REQUIRE(libwallet::parse_amount("184467440737.09551614") ==
+        18446744073709551614u);
+    BOOST_REQUIRE(libwallet::parse_amount("200000000000") ==
+        libwallet::invalid_amount);
+    BOOST_REQUIRE(libwallet::parse_amount("0000000000000000000000001") ==
+        100000000);
+    BOOST_REQUIRE(libwallet::parse_amount("1.000000000000000000009") ==
+        100000000);
+
+    const auto amounts = libwallet::parse_amounts({"1", "0.5", "x", ""});
+    BOOST_REQUIRE(amounts.size() == 4);
+    BOOST_REQUIRE(amounts[0] == 100000000);
+    BOOST_REQUIRE(amounts[1] == 50000000);
+    BOOST_REQUIRE(amounts[2] == libwallet::invalid_amount);
+    BOOST_REQUIRE(amounts[3] == 0);
 }
 
 BOOST_AUTO_TEST_CASE(uri_write_test)
@@ -258,4 +358,84 @@ BOOST_AUTO_TEST_CASE(uri_write_test)
         "label=%26%3D%0A&"
         "message=hello%20bitcoin&"
         "r=http://example.com?purchase%3Dshoes%26user%3Dbob");
+
+    // Whole coins, sub-satoshi digits and bytes above 0x7f:
+    libwallet::uri_writer other;
+    other.write_amount(0);
+    other.write_amount(1);
+    other.write_amount(2100000000000000);
+    other.write_label("caf\xc3\xa9");
+    BOOST_REQUIRE(other.string() ==
+        "bitcoin:?amount=0&amount=0.00000001&amount=21000000&"
+        "label=caf%C3%A9");
+}
+
+BOOST_AUTO_TEST_CASE(uri_parse_batch_test)
+{
+    const std::vector<std::string> uris{
+        "bitcoin:113Pfw4sFqN1T5kXUnKbqZHMJHN9oyjtgD?amount=0.1",
+        "bitcoin:?label=test&message=hello%20bitcoin",
+        "bitcoin:?label=dropped&amount=4.2.1",
+        "bitcoin:?req-somethingyoudontunderstand=50&label=dropped",
+        "bitcoin:?r=http://www.example.com?purchase%3Dshoes"};
+    const auto result = libwallet::uri_parse_batch(uris);
+    BOOST_REQUIRE(result.valid.size() == 5);
+    BOOST_REQUIRE(result.r.size() == 5);
+
+    BOOST_REQUIRE(result.valid[0]);
+    BOOST_REQUIRE(result.address[0] && result.address[0].get().encoded() ==
+        "113Pfw4sFqN1T5kXUnKbqZHMJHN9oyjtgD");
+    BOOST_REQUIRE(result.amount[0] && result.amount[0].get() == 10000000);
+    BOOST_REQUIRE(!result.label[0]);
+
+    BOOST_REQUIRE(result.valid[1]);
+    BOOST_REQUIRE(!result.address[1]);
+    BOOST_REQUIRE(result.label[1] && result.label[1].get() == "test");
+    BOOST_REQUIRE(result.message[1] &&
+        result.message[1].get() == "hello bitcoin");
+
+    BOOST_REQUIRE(!result.valid[2]);
+    BOOST_REQUIRE(!result.label[2]);
+    BOOST_REQUIRE(!result.valid[3]);
+    BOOST_REQUIRE(!result.label[3]);
+
+    BOOST_REQUIRE(result.valid[4]);
+    BOOST_REQUIRE(result.r[4] &&
+        result.r[4].get() == "http://www.example.com?purchase=shoes");
 }
+
+BOOST_AUTO_TEST_CASE(uri_parse_address_cache_test)
+{
+    libwallet::address_cache cache(2, 1);
+    libwallet::uri_parse_result result(&cache);
+    BOOST_REQUIRE(libwallet::uri_parse(
+        "bitcoin:113Pfw4sFqN1T5kXUnKbqZHMJHN9oyjtgD", result));
+    BOOST_REQUIRE(libwallet::uri_parse(
+        "bitcoin:113Pfw4sFqN1T5kXUnKbqZHMJHN9oyjtgD?amount=1", result));
+    BOOST_REQUIRE(result.address && result.address.get().encoded() ==
+        "113Pfw4sFqN1T5kXUnKbqZHMJHN9oyjtgD");
+    BOOST_REQUIRE(cache.size() == 1);
+
+    // Invalid addresses are not cached:
+    BOOST_REQUIRE(!libwallet::uri_parse("bitcoin:19z88", result));
+    BOOST_REQUIRE(cache.size() == 1);
+
+    // The least recently used address is dropped:
+    libbitcoin::payment_address address;
+    BOOST_REQUIRE(cache.set_encoded(address,
+        "1BoatSLRHtKNngkdXEeobR76b53LETtpyT"));
+    BOOST_REQUIRE(cache.set_encoded(address,
+        "1111111111111111111114oLvT2"));
+    BOOST_REQUIRE(cache.size() == 2);
+    BOOST_REQUIRE(address.encoded() == "1111111111111111111114oLvT2");
+    BOOST_REQUIRE(!cache.contains("113Pfw4sFqN1T5kXUnKbqZHMJHN9oyjtgD"));
+    BOOST_REQUIRE(cache.contains("1BoatSLRHtKNngkdXEeobR76b53LETtpyT"));
+    BOOST_REQUIRE(cache.contains("1111111111111111111114oLvT2"));
+
+    const auto batch = libwallet::uri_parse_batch(
+        {"bitcoin:1BoatSLRHtKNngkdXEeobR76b53LETtpyT"}, true, &cache);
+    BOOST_REQUIRE(batch.valid[0] && batch.address[0]);
+    cache.clear();
+    BOOST_REQUIRE(cache.size() == 0);
+}
+
@@ -0,0 +1,126 @@
+/*
+ * Copyright (c) 2011-2013 libwallet developers (see AUTHORS)
+ *
+ * This file is part of libwallet.
+ *
+ * libwallet is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License with
+ * additional permissions to the one published by the Free Software
+ * Foundation, either version 3 of the License, or (at your option)
+ * any later version. For more information see LICENSE.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <random>
+#include <boost/test/unit_test.hpp>
+#include <bitcoin/bitcoin.hpp>
+#include <wallet/wallet.hpp>
+
+using namespace libwallet;
+
+BOOST_AUTO_TEST_CASE(base58_prefix_test)
+{
+    BOOST_REQUIRE(base58_prefix("1").valid());
+    BOOST_REQUIRE(base58_prefix("1Kid").valid());
+    BOOST_REQUIRE(!base58_prefix("1Kid0").valid());
+    BOOST_REQUIRE(!base58_prefix("1Kidl").valid());
+    BOOST_REQUIRE(!base58_prefix(std::string(40, 'z')).valid());
+
+    // Prefixes only some version bytes can reach:
+    BOOST_REQUIRE(base58_prefix("1Kid").reachable(0x00));
+    BOOST_REQUIRE(!base58_prefix("1Kid").reachable(0x05));
+    BOOST_REQUIRE(base58_prefix("3").reachable(0x05));
+    BOOST_REQUIRE(!base58_prefix("3").reachable(0x00));
+    BOOST_REQUIRE(!base58_prefix("2").reachable(0x05));
+    BOOST_REQUIRE(base58_prefix("").reachable(0x05));
+    BOOST_REQUIRE(base58_prefix("11").reachable(0x00));
+
+    // Same answers as encoding the address, for prefixes of addresses
+    // with any number of leading zeros:
+    std::mt19937 random(7);
+    const uint8_t versions[] = {0x00, 0x05, 0x6f};
+    std::vector<payment_address> addresses;
+    for (size_t n = 0; n < 300; ++n)
+    {
+        short_hash hash;
+        for (auto& byte: hash)
+            byte = static_cast<uint8_t>(random());
+        for (size_t i = 0; i < n % 3; ++i)
+            hash[i] = 0;
+        addresses.push_back(payment_address(versions[n % 3], hash));
+    }
+    for (size_t n = 0; n < 300; ++n)
+    {
+        const std::string source = addresses[random() % 300].encoded();
+        const base58_prefix prefix(source.substr(0, 1 + random() % 5));
+        BOOST_REQUIRE(prefix.valid());
+        for (const payment_address& address: addresses)
+        {
+            const bool expected =
+                address.encoded().compare(0, prefix.text().size(),
+                    prefix.text()) == 0;
+            BOOST_REQUIRE(prefix.matches(address.version(), address.hash())
+                == expected);
+        }
+    }
+}
+
+BOOST_AUTO_TEST_CASE(find_vanity_children_test)
+{
+    hd_public_key account;
+    BOOST_REQUIRE(account.set_serialized(
+        "xpub6FnCn6nSzZAw5Tw7cgR9bi15UV96gLZhjDstkXXxvCLsUXBGXPdS"
+        "nLFbdpq8p9HmGsApME5hQTZ3emM2rnY5agb9rXpVGyy3bdW6EEgAtqt"));
+
+    // Compare against deriving every child:
+    const base58_prefix prefix(
+        account.generate_public_key(7).address().encoded().substr(0, 2));
+    std::vector<uint32_t> expected;
+    for (uint32_t index = 5; index < 305; ++index)
+        if (account.generate_public_key(index).address().encoded().compare(
+            0, 2, prefix.text()) == 0)
+            expected.push_back(index);
+    BOOST_REQUIRE(!expected.empty() && expected.front() == 7);
+
+    BOOST_REQUIRE(find_vanity_children(account, prefix, 5, 300, 1000, 3)
+        == expected);
+    const auto first = find_vanity_children(account, prefix, 5, 300, 2, 3);
+    BOOST_REQUIRE(first.size() == std::min<size_t>(2, expected.size()));
+    BOOST_REQUIRE(std::equal(first.begin(), first.end(), expected.begin()));
+
+    // Nothing beyond the last non-hardened index:
+    BOOST_REQUIRE(find_vanity_children(account, base58_prefix("1"),
+        first_hardened_key - 2, 10, 10) ==
+        std::vector<uint32_t>({first_hardened_key - 2,
+            first_hardened_key - 1}));
+}
+
+BOOST_AUTO_TEST_CASE(find_vanity_stealth_test)
+{
+    const ec_secret scan_secret = new_secret();
+    const ec_secret spend_secret = new_secret();
+    const ec_point scan_pubkey = secret_to_public_key(scan_secret);
+    const ec_point spend_pubkey = secret_to_public_key(spend_secret);
+
+    ec_secret ephem_secret;
+    const base58_prefix prefix("1A");
+    BOOST_REQUIRE(find_vanity_stealth(scan_pubkey, spend_pubkey, prefix,
+        ephem_secret, 100000, 2));
+
+    // The receiver finds the same address:
+    payment_address address;
+    set_public_key(address, uncover_stealth(
+        secret_to_public_key(ephem_secret), scan_secret, spend_pubkey));
+    BOOST_REQUIRE(address.encoded().compare(0, 2, "1A") == 0);
+
+    // Unreachable prefixes fail at once rather than search forever:
+    BOOST_REQUIRE(!find_vanity_stealth(scan_pubkey, spend_pubkey,
+        base58_prefix("3"), ephem_secret));
+}
+